@@ -0,0 +1,75 @@
+/**
+ ******************************************************************************
+ * @file	autotune.h
+ * @brief	Réglage automatique d'un PI par essai au relais (Åström-Hägglund)
+ ******************************************************************************
+ *
+ * La sortie du procédé est commandée par un relais à hystérésis autour de la
+ * consigne : u = u0 + d si l'erreur dépasse eps, u0 - d si elle passe sous
+ * -eps. Le procédé entre en cycle limite ; après quelques cycles de
+ * transitoire, la période Tu et l'amplitude a de la mesure sont moyennées
+ * sur plusieurs cycles. Le premier harmonique donne le gain critique
+ * Ku = 4.d / (pi.sqrt(a² - eps²)), d'où les gains PI (Ziegler-Nichols ou
+ * Tyreus-Luyben, plus amorti).
+ *
+ * at_update() est appelée à chaque période d'échantillonnage de la boucle
+ * réglée et rend la commande à appliquer. Aucune dépendance à la HAL : la
+ * même logique tourne sur la carte et contre un modèle de moteur sur PC.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_AUTOTUNE_H_
+#define INC_AUTOTUNE_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported macros -----------------------------------------------------------*/
+// États
+#define AT_IDLE 0
+#define AT_RUNNING 1
+#define AT_DONE 2
+#define AT_FAILED 3				// pas de cycle limite exploitable avant le délai
+
+// Règles de réglage
+#define AT_RULE_ZN 0			// Ziegler-Nichols : Kp = 0,45.Ku, Ti = Tu / 1,2
+#define AT_RULE_TL 1			// Tyreus-Luyben : Kp = Ku / 3,2, Ti = 2,2.Tu
+/* End of exported macros ----------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct{
+	// Essai
+	float ref;					// consigne (unité de la mesure)
+	float u0;					// commande au repos
+	float d;					// amplitude du relais
+	float eps;					// hystérésis (unité de la mesure)
+	float te;					// période d'échantillonnage (s)
+	uint8_t skip;				// cycles de transitoire ignorés
+	uint8_t cycles;				// cycles moyennés
+	uint32_t timeout;			// échantillons avant abandon
+
+	// Cycle limite (ISR)
+	volatile uint8_t state;
+	int8_t sign;				// +1 : relais haut
+	uint32_t n;					// échantillons depuis le départ
+	uint32_t last_rise;			// dernier passage en relais haut
+	uint8_t rises;				// passages en relais haut
+	float y_max;				// extrema du cycle en cours
+	float y_min;
+	float sum_period;			// échantillons
+	float sum_amplitude;
+
+	// Résultat
+	float tu;					// période (s)
+	float a;					// amplitude crête de la mesure
+	float ku;					// gain critique
+} at_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+void at_start(at_t * at, float ref, float u0, float d, float eps, float te, float timeout_s);
+float at_update(at_t * at, float y);
+int at_gains(const at_t * at, uint8_t rule, float * kp, float * ki);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_AUTOTUNE_H_ */
@@ -0,0 +1,46 @@
+/**
+ ******************************************************************************
+ * @file	cobs.h
+ * @brief	Trames binaires : codage COBS et CRC-16/CCITT-FALSE
+ ******************************************************************************
+ *
+ * Trame sur la liaison : 0x00 | COBS(type, seq, données, crc16) | 0x00
+ * crc16 : CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) sur type, seq et
+ * données, transmis poids faible en premier.
+ *
+ * Même code sur la carte (PROTOCOL.c) et sur le PC (bibliothèque hôte,
+ * test et banc de débit dans Common/test) : aucune dépendance à la HAL.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_COBS_H_
+#define INC_COBS_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported macros -----------------------------------------------------------*/
+#define COBS_CRC_INIT 0xFFFF
+
+// Message (type, seq, données, crc16) pour len octets de données
+#define COBS_MSG_SIZE(len) ((len) + 4)
+// COBS : un octet de code tous les 254 octets, plus le code initial
+#define COBS_ENCODED_MAX_SIZE(n) ((n) + (n) / 254 + 1)
+// Trame complète au pire, délimiteurs compris
+#define COBS_FRAME_MAX_SIZE(len) (COBS_ENCODED_MAX_SIZE(COBS_MSG_SIZE(len)) + 2)
+
+// Erreurs de cobs_frame_decode()
+#define COBS_ERR_CODING -1			// codage COBS invalide ou message trop court
+#define COBS_ERR_CRC -2
+/* End of macros -------------------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+uint16_t cobs_crc16(const uint8_t * data, uint16_t len, uint16_t crc);
+uint16_t cobs_encode(const uint8_t * src, uint16_t len, uint8_t * dst);
+int cobs_decode(const uint8_t * src, uint16_t len, uint8_t * dst);
+
+uint16_t cobs_frame_encode(uint8_t type, uint8_t seq, const uint8_t * data, uint16_t len, uint8_t * dst);
+int cobs_frame_decode(const uint8_t * src, uint16_t len, uint8_t * msg);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_COBS_H_ */
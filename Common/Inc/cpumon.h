@@ -0,0 +1,86 @@
+/**
+ ******************************************************************************
+ * @file	cpumon.h
+ * @brief	Charge CPU par comptage de la boucle d'attente et gigue des
+ *			interruptions périodiques
+ ******************************************************************************
+ *
+ * Charge : la boucle principale appelle cpuload_idle() à chaque tour sans
+ * travail. cpuload_calibrate() mesure au démarrage le coût d'un tour à vide,
+ * interruptions masquées, avec exactement le même code. Sur une fenêtre,
+ * temps libre = tours à vide x coût d'un tour, charge = 1 - libre / fenêtre,
+ * en pour mille. cpuload_update() ferme la fenêtre (toutes les secondes) et
+ * tient le pic et l'alerte de dépassement du seuil. Écrivain unique : la
+ * boucle principale.
+ *
+ * Gigue : jitter_stamp() date chaque entrée d'une ISR périodique ; l'écart
+ * à la période nominale est accumulé (min, max signés, moyenne des valeurs
+ * absolues, histogramme log2 des valeurs absolues, case k : 2^k à
+ * 2^(k+1) - 1). Un intervalle d'au moins deux périodes (ISR arrêtée ou
+ * période manquée) est compté à part et ne fausse pas la distribution.
+ * Écrivain unique : l'ISR ; remise à zéro par demande, appliquée à l'entrée
+ * suivante.
+ *
+ * Horloge en unités quelconques (cycles DWT sur la carte) : aucune
+ * dépendance à la HAL.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_CPUMON_H_
+#define INC_CPUMON_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported macros -----------------------------------------------------------*/
+#define CPULOAD_FULL 1000			// pour mille
+#define CPULOAD_COST_SHIFT 8		// coût d'un tour à vide en Q8
+#define JITTER_HIST_BINS 16			// 2^16 cycles : ~0,4 ms à 170 MHz
+/* End of exported macros ----------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct{
+	uint32_t idle;				// tours à vide depuis le démarrage
+	uint32_t cost;				// coût d'un tour à vide, Q8
+
+	uint32_t win_start;			// horloge au début de la fenêtre
+	uint32_t win_idle;			// tours à vide au début de la fenêtre
+
+	uint16_t load;				// dernière fenêtre, pour mille
+	uint16_t peak;
+	uint16_t threshold;			// alerte au-dessus, pour mille
+	uint8_t warning;			// dernière fenêtre au-dessus du seuil
+	uint32_t warnings;			// passages au-dessus du seuil
+} cpuload_t;
+
+typedef struct{
+	uint32_t period;			// nominale
+	uint32_t last;
+	uint8_t started;
+
+	uint32_t n;
+	int32_t dev_last;
+	int32_t dev_min;
+	int32_t dev_max;
+	uint64_t abs_sum;
+	uint32_t hist[JITTER_HIST_BINS];
+	uint32_t gaps;				// intervalles d'au moins deux périodes
+
+	volatile uint8_t req_reset;
+} jitter_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+void cpuload_init(cpuload_t * l, uint16_t threshold);
+void cpuload_idle(cpuload_t * l);
+void cpuload_calibrate(cpuload_t * l, uint32_t cycles, uint32_t loops, uint32_t now);
+uint16_t cpuload_update(cpuload_t * l, uint32_t now);
+void cpuload_clear(cpuload_t * l);
+
+void jitter_init(jitter_t * j, uint32_t period);
+void jitter_stamp(jitter_t * j, uint32_t now);
+void jitter_reset(jitter_t * j);
+uint32_t jitter_mean(const jitter_t * j);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_CPUMON_H_ */
@@ -0,0 +1,49 @@
+/**
+ ******************************************************************************
+ * @file	encoder.h
+ * @brief	Position codeur absolue à partir d'un compteur 32 bits libre
+ ******************************************************************************
+ *
+ * Le compteur du timer (TIM2 en mode codeur, ARR = 0xFFFFFFFF) n'est jamais
+ * écrit : chaque enc_update() calcule l'écart avec la lecture précédente en
+ * arithmétique modulo 2^32, aucun pas n'est perdu et le débordement du
+ * compteur est transparent tant que moins de 2^31 pas séparent deux appels.
+ *
+ * Un seul écrivain (l'interruption d'échantillonnage) appelle enc_update().
+ * Les lecteurs, de priorité quelconque, obtiennent par enc_get() une copie
+ * cohérente sans masquer les interruptions : l'écrivain remplit le tampon
+ * inactif puis publie son numéro de séquence, le lecteur recommence si une
+ * publication a eu lieu pendant sa copie. Aucune dépendance à la HAL.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_ENCODER_H_
+#define INC_ENCODER_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct{
+	int64_t position;			// pas depuis enc_init()
+	int32_t revolutions;		// tours complets (arrondi vers -inf)
+	uint32_t angle;				// pas dans le tour, 0..ticks_per_rev-1
+	int32_t delta;				// pas depuis l'échantillon précédent
+	uint32_t samples;			// nombre d'appels à enc_update()
+} enc_snapshot_t;
+
+typedef struct{
+	uint32_t ticks_per_rev;
+	uint32_t last_cnt;
+	volatile uint32_t seq;		// tampon publié : snap[seq & 1]
+	enc_snapshot_t snap[2];
+} enc_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+void enc_init(enc_t * enc, uint32_t cnt, uint32_t ticks_per_rev);
+int32_t enc_update(enc_t * enc, uint32_t cnt);
+void enc_get(const enc_t * enc, enc_snapshot_t * snap);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_ENCODER_H_ */
@@ -0,0 +1,46 @@
+/**
+ ******************************************************************************
+ * @file	fault.h
+ * @brief	Verrouillage des défauts matériels (surintensité...)
+ ******************************************************************************
+ *
+ * fault_trip() est appelée par l'interruption qui a détecté le défaut, après
+ * la mise en sécurité de la puissance : seul le premier événement est
+ * enregistré (source, voie, valeur, instant), les suivants ne font
+ * qu'incrémenter le compteur. Le défaut reste verrouillé jusqu'à
+ * fault_rearm(), appelée depuis la boucle principale sur demande explicite.
+ * Aucune dépendance à la HAL.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_FAULT_H_
+#define INC_FAULT_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported macros -----------------------------------------------------------*/
+// Sources
+#define FAULT_NONE 0
+#define FAULT_OVERCURRENT 1
+/* End of exported macros ----------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct{
+	volatile uint8_t source;	// FAULT_NONE tant qu'aucun défaut n'est verrouillé
+	uint8_t channel;
+	int32_t value;				// grandeur au déclenchement (mA pour une surintensité)
+	uint32_t cycles;			// horodatage, cycles CPU
+	uint32_t tick;				// horodatage, ms
+	volatile uint32_t trips;	// déclenchements depuis le démarrage
+} fault_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+void fault_init(fault_t * fault);
+int fault_trip(fault_t * fault, uint8_t source, uint8_t channel, int32_t value, uint32_t cycles, uint32_t tick);
+int fault_rearm(fault_t * fault);
+uint8_t fault_latched(const fault_t * fault);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_FAULT_H_ */
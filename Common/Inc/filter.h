@@ -0,0 +1,56 @@
+/**
+ ******************************************************************************
+ * @file	filter.h
+ * @brief	Filtres numériques en virgule fixe pour mesures 16 bits
+ ******************************************************************************
+ *
+ * Un filtre par voie, appelé à chaque échantillon (ISR) :
+ *  - FILT_IIR : passe-bas du premier ordre y += (x - y) / 2^order, état Q8,
+ *    constante de temps ~2^order échantillons ;
+ *  - FILT_MA : moyenne glissante sur 2^order échantillons, somme courante.
+ * Ni multiplication ni division : additions et décalages uniquement.
+ *
+ * filt_config() (boucle principale) dépose une demande, appliquée par
+ * l'ISR au début du filt_update() suivant : type, ordre et état changent
+ * ensemble, l'état repart de l'échantillon courant (pas d'à-coup).
+ * Aucune dépendance à la HAL.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_FILTER_H_
+#define INC_FILTER_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported macros -----------------------------------------------------------*/
+#define FILT_NONE 0
+#define FILT_IIR 1
+#define FILT_MA 2
+
+#define FILT_IIR_MAX_ORDER 8		// état Q8 : au-delà, perte de résolution
+#define FILT_MA_MAX_ORDER 4			// 16 échantillons
+/* End of exported macros ----------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct{
+	uint8_t type;
+	uint8_t order;
+	int32_t acc;				// IIR : y en Q8, MA : somme de la fenêtre
+	uint16_t hist[1 << FILT_MA_MAX_ORDER];
+	uint8_t idx;
+
+	// Demande de changement (boucle principale -> ISR)
+	volatile uint8_t req_type;
+	volatile uint8_t req_order;
+	volatile uint8_t req;
+} filt_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+void filt_init(filt_t * f);
+int filt_config(filt_t * f, uint8_t type, uint8_t order);
+uint16_t filt_update(filt_t * f, uint16_t x);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_FILTER_H_ */
@@ -0,0 +1,45 @@
+/**
+ ******************************************************************************
+ * @file	fmt.h
+ * @brief	Formatage entier et virgule fixe, sans allocation ni flottant
+ ******************************************************************************
+ *
+ * Remplace printf("%f") : pas de newlib, pas de tas, utilisable en ISR.
+ * Les fonctions fmt_* écrivent dans un buffer fourni (terminé par '\0') et
+ * renvoient la longueur écrite. Les fonctions fmt_put* écrivent directement
+ * sur la sortie déclarée par fmt_set_output() (file d'émission uart).
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_FMT_H_
+#define INC_FMT_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef int (* fmt_write_t)(char * s, uint16_t size);
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported macros -----------------------------------------------------------*/
+#define FMT_I32_MAX_SIZE 12			// "-2147483648" + '\0'
+#define FMT_FIXED_MAX_SIZE 14		// signe, 10 chiffres, point, '\0'
+#define FMT_Q16_MAX_DECIMALS 4
+/* End of exported macros ----------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+int fmt_u32(char * dst, uint32_t v);
+int fmt_i32(char * dst, int32_t v);
+int fmt_fixed(char * dst, int32_t v, uint8_t decimals);
+int fmt_q16(char * dst, int32_t v, uint8_t decimals);
+int fmt_parse_fixed(const char * s, uint8_t decimals, int32_t * v);
+
+void fmt_set_output(fmt_write_t write);
+void fmt_puts(const char * s);
+void fmt_put_u32(uint32_t v);
+void fmt_put_i32(int32_t v);
+void fmt_put_fixed(int32_t v, uint8_t decimals);
+void fmt_put_q16(int32_t v, uint8_t decimals);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_FMT_H_ */
@@ -0,0 +1,37 @@
+/**
+ ******************************************************************************
+ * @file	pi.h
+ * @brief	Régulateur PI discret avec saturation et anti-windup
+ ******************************************************************************
+ *
+ * Aucune dépendance à la HAL : utilisable en ISR sur la cible et compilable
+ * sur un hôte contre un modèle du moteur. Les gains et les bornes sont des
+ * float 32 bits, modifiables à la volée sans masquer les interruptions.
+ *
+ * u = ff + kp.e + somme(ki.Te.e), borné à [out_min, out_max]. L'intégrale est
+ * gelée tant que la sortie est saturée dans le sens de l'erreur.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_PI_H_
+#define INC_PI_H_
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct{
+	volatile float kp;
+	volatile float ki;			// gain intégral (1/s)
+	float te;					// période d'échantillonnage (s)
+	volatile float out_min;
+	volatile float out_max;
+	float integ;				// terme intégral courant
+	float out;					// dernière sortie
+} pi_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+void pi_init(pi_t * pi, float kp, float ki, float te, float out_min, float out_max);
+void pi_reset(pi_t * pi, float integ);
+float pi_update(pi_t * pi, float err, float ff);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_PI_H_ */
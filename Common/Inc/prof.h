@@ -0,0 +1,65 @@
+/**
+ ******************************************************************************
+ * @file	prof.h
+ * @brief	Profilage par compteur de cycles : min, max, moyenne, histogramme
+ ******************************************************************************
+ *
+ * Un site par ISR ou tâche à mesurer. PROF_START() date l'entrée, PROF_STOP()
+ * ajoute la durée au site : min, max, somme (moyenne = somme / n) et
+ * histogramme log2, case k : durées de 2^k à 2^(k+1) - 1 cycles (case 0 :
+ * 0 ou 1 cycle, dernière case : tout ce qui dépasse).
+ *
+ * Un seul écrivain par site (une ISR ne se préempte pas elle-même) : aucun
+ * masquage d'interruption à la mesure. La remise à zéro est une demande,
+ * appliquée par l'écrivain à la mesure suivante.
+ *
+ * Actif en configuration Debug (DEBUG) ou avec PROF_ENABLE ; sinon les
+ * marqueurs ne génèrent aucun code. PROF_CLOCK() est fournie par
+ * l'application avant le premier marqueur (DWT->CYCCNT sur la carte) :
+ * aucune dépendance à la HAL.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_PROF_H_
+#define INC_PROF_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported macros -----------------------------------------------------------*/
+#if defined(DEBUG) && !defined(PROF_ENABLE)
+#define PROF_ENABLE
+#endif
+
+#define PROF_HIST_BINS 20			// 2^20 cycles : ~6 ms à 170 MHz
+
+#ifdef PROF_ENABLE
+#define PROF_START(t) uint32_t t = PROF_CLOCK()
+#define PROF_STOP(site, t) prof_add(&(site), PROF_CLOCK() - (t))
+#else
+#define PROF_START(t)
+#define PROF_STOP(site, t) ((void)0)
+#endif
+/* End of exported macros ----------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct{
+	const char * name;
+	uint32_t n;
+	uint32_t min;
+	uint32_t max;
+	uint64_t sum;
+	uint32_t hist[PROF_HIST_BINS];
+
+	volatile uint8_t req_reset;	// demande de remise à zéro (lecteur -> écrivain)
+} prof_site_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+void prof_init(prof_site_t * site, const char * name);
+void prof_add(prof_site_t * site, uint32_t cycles);
+void prof_reset(prof_site_t * site);
+uint32_t prof_mean(const prof_site_t * site);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_PROF_H_ */
@@ -0,0 +1,87 @@
+/**
+ ******************************************************************************
+ * @file	sched.h
+ * @brief	Exécutif coopératif à déclenchement temporel
+ ******************************************************************************
+ *
+ * sched_tick() est appelée par l'interruption d'un timer matériel : une
+ * tâche est libérée aux ticks offset, offset + period, ... et son instant de
+ * libération est daté. sched_run(), dans la boucle principale, exécute les
+ * tâches libérées dans l'ordre d'enregistrement (priorité décroissante),
+ * chacune jusqu'au bout.
+ *
+ * Par tâche : durée d'exécution (dernière, max), latence libération ->
+ * démarrage (jitter = max - min), échéances manquées (libérée à nouveau
+ * avant d'avoir démarré, échéance implicite = période) et dépassements du
+ * budget. Après SCHED_OVERRUN_LIMIT dépassements consécutifs d'une même
+ * tâche, l'exécutif passe en mode dégradé : seules les tâches
+ * SCHED_ESSENTIAL sont encore libérées, et la fonction de repli de
+ * l'application est appelée une fois. sched_clear() en sort.
+ *
+ * Compteurs de libération (ISR) et de démarrage (boucle principale) à
+ * écrivain unique : aucun masquage d'interruption. L'horloge est une
+ * fonction fournie à sched_init() (cycles DWT sur la carte, horloge
+ * virtuelle sur PC) : aucune dépendance à la HAL.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_SCHED_H_
+#define INC_SCHED_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported macros -----------------------------------------------------------*/
+#define SCHED_MAX_TASKS 8
+#define SCHED_OVERRUN_LIMIT 3		// dépassements consécutifs avant le mode dégradé
+
+// Options des tâches
+#define SCHED_ESSENTIAL 0x01		// toujours exécutée, y compris en mode dégradé
+/* End of exported macros ----------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct{
+	const char * name;
+	void (* func)(void);
+	uint32_t period;			// ticks
+	uint32_t offset;			// ticks, < period
+	uint32_t budget;			// unités d'horloge
+	uint8_t flags;
+
+	// Libération (ISR)
+	uint32_t countdown;			// ticks avant la prochaine libération
+	volatile uint32_t released;
+	volatile uint32_t release_time;
+	volatile uint32_t misses;
+
+	// Exécution (boucle principale)
+	uint32_t started;
+	uint32_t runs;
+	uint32_t exec_last;
+	uint32_t exec_max;
+	uint32_t latency_min;
+	uint32_t latency_max;
+	uint32_t overruns;
+	uint8_t consecutive;
+} sched_task_t;
+
+typedef struct{
+	sched_task_t tasks[SCHED_MAX_TASKS];
+	uint8_t n;
+	volatile uint32_t tick;
+	uint32_t (* clock)(void);
+	void (* fallback)(uint8_t task);	// entrée en mode dégradé, tâche en cause
+	volatile uint8_t degraded;
+} sched_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+void sched_init(sched_t * s, uint32_t (* clock)(void), void (* fallback)(uint8_t task));
+int sched_add(sched_t * s, const char * name, void (* func)(void), uint32_t period, uint32_t offset,
+		uint32_t budget, uint8_t flags);
+void sched_tick(sched_t * s);
+uint8_t sched_run(sched_t * s);
+void sched_clear(sched_t * s);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_SCHED_H_ */
@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ * @file	scope.h
+ * @brief	Oscilloscope en RAM : pré-déclenchement, déclenchement, vidage
+ ******************************************************************************
+ *
+ * Chaque appel de scope_sample() (ISR, après décimation) range les voies
+ * sélectionnées d'un échantillon en int16 entrelacés dans un tampon
+ * circulaire unique : la profondeur vaut SCOPE_BUFFER_SIZE / nombre de voies,
+ * toute la mémoire sert quel que soit le masque.
+ *
+ * Une fois armé, le scope attend d'avoir pre échantillons avant de tester le
+ * déclenchement (front montant ou descendant, niveau au-dessus ou en dessous,
+ * sur n'importe quelle voie, même non enregistrée), ou une demande manuelle
+ * (scope_force). Il remplit ensuite la fenêtre post-déclenchement puis passe
+ * à SCOPE_DONE : l'ISR n'écrit plus et scope_dump() envoie le tampon, du plus
+ * ancien au plus récent, en une rafale de trames. Aucune dépendance à la HAL.
+ *
+ * Trames : une trame d'entête (indice 0xFFFF, masque uint8, profondeur,
+ * pré-déclenchement et décimation uint16), puis des trames de données (indice
+ * du premier échantillon uint16, échantillons int16), little-endian.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_SCOPE_H_
+#define INC_SCOPE_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported macros -----------------------------------------------------------*/
+#define SCOPE_CHANNELS 4			// voies disponibles (8 au plus, masque uint8)
+#define SCOPE_BUFFER_SIZE 8192		// int16, 16 ko
+
+// États
+#define SCOPE_IDLE 0
+#define SCOPE_ARMED 1				// pré-déclenchement, attente du déclenchement
+#define SCOPE_TRIGGERED 2			// remplissage post-déclenchement
+#define SCOPE_DONE 3				// acquisition terminée, vidage en cours
+
+// Conditions de déclenchement
+#define SCOPE_TRIG_MANUAL 0			// scope_force() uniquement
+#define SCOPE_TRIG_RISING 1			// précédent < niveau <= courant
+#define SCOPE_TRIG_FALLING 2		// précédent > niveau >= courant
+#define SCOPE_TRIG_ABOVE 3			// courant >= niveau
+#define SCOPE_TRIG_BELOW 4			// courant <= niveau
+
+#define SCOPE_HEADER_INDEX 0xFFFF
+/* End of exported macros ----------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+// Émission d'une trame : 0 si acceptée, -1 pour réessayer plus tard
+typedef int (* scope_send_t)(const uint8_t * data, uint16_t len);
+
+typedef struct{
+	int16_t buf[SCOPE_BUFFER_SIZE];
+
+	// Configuration, modifiable scope arrêté
+	uint8_t mask;				// voies enregistrées
+	uint16_t pre;				// échantillons avant le déclenchement
+	uint16_t decimation;		// 1 échantillon tous les n appels
+	uint8_t trig_ch;
+	uint8_t trig_mode;
+	int16_t trig_level;
+
+	// Acquisition (ISR)
+	volatile uint8_t state;
+	volatile uint8_t force;		// déclenchement manuel demandé
+	uint8_t n;					// voies par échantillon
+	uint16_t depth;				// échantillons par voie
+	uint16_t count;				// compteur de décimation
+	uint16_t widx;				// prochain échantillon écrit
+	uint16_t filled;			// échantillons écrits depuis l'armement, jusqu'à pre
+	uint16_t post;				// échantillons restant après le déclenchement
+	int16_t prev;				// valeur précédente de la voie de déclenchement
+	uint16_t start;				// plus ancien échantillon, acquisition terminée
+
+	// Vidage (boucle principale)
+	uint16_t dump_idx;
+	uint8_t dump_header;
+} scope_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+void scope_init(scope_t * scope);
+int scope_arm(scope_t * scope);
+void scope_force(scope_t * scope);
+void scope_stop(scope_t * scope);
+void scope_sample(scope_t * scope, const int16_t * values);
+uint8_t scope_dump(scope_t * scope, scope_send_t send, uint16_t max_len);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_SCOPE_H_ */
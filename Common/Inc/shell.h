@@ -0,0 +1,59 @@
+/**
+ ******************************************************************************
+ * @file	shell.h
+ * @author 	Arnaud CHOBERT
+ * @brief	Shell commun TP/TD, indépendant du transport
+ ******************************************************************************
+ *
+ * Le shell ne connaît ni la HAL ni l'uart : il lit et écrit au travers d'un
+ * shell_io_t (voir shell_uart.h pour la liaison LPUART/DMA). Il se compile
+ * donc aussi bien pour la cible que pour un hôte Linux (stdin/stdout).
+ *
+ * Les deux styles de commande cohabitent dans la même table :
+ * - commande nommée : "help", "isr reset"
+ * - commande à une lettre : "s 50", et tout préfixe non ambigu d'un nom
+ *   ("h" pour "help", "t" pour "tx")
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_SHELL_H_
+#define INC_SHELL_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct{
+	const char * cmd;
+	int (* func)(int argc, char ** argv);
+	const char * description;
+} shell_func_t;
+
+typedef struct{
+	int (* write)(char * s, uint16_t size);	// écriture non bloquante, renvoie le nombre d'octets pris
+	int (* read)(char * ch);				// 1 : caractère lu, 0 : rien en attente, -1 : flux perdu
+} shell_io_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported macros -----------------------------------------------------------*/
+/**
+ * Déclaration d'une commande du shell, placée en flash dans la section
+ * .shell_cmd.<name>. L'éditeur de liens trie ces sections par nom
+ * (SORT_BY_NAME dans le .ld), la table est donc déjà triée pour la
+ * recherche dichotomique. name doit être un identifiant C valide.
+ */
+#define SHELL_CMD(name, pfunc, desc) \
+	static const shell_func_t shell_cmd_##name \
+	__attribute__((used, aligned(4), section(".shell_cmd." #name))) = { #name, pfunc, desc }
+/* End of exported macros ----------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+void shell_init(const shell_io_t * io, const char * prompt);
+void shell_process();
+void shell_set_frame_handler(int (* handler)(uint8_t ch));
+int shell_exec(char * cmd);
+const shell_func_t * shell_find(const char * cmd, size_t len);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_SHELL_H_ */
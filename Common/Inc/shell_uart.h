@@ -0,0 +1,66 @@
+/**
+ ******************************************************************************
+ * @file	shell_uart.h
+ * @author 	Arnaud CHOBERT
+ * @brief	Transport uart du shell : émission et réception par DMA
+ ******************************************************************************
+ *
+ * L'uart est passée par handle à uart_init() : la liaison (LPUART1 ici) et
+ * ses canaux DMA restent déclarés dans usart.c. Le HAL_UARTEx_RxEventCallback
+ * de l'application doit appeler uart_rx_event().
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_SHELL_UART_H_
+#define INC_SHELL_UART_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "main.h"
+#include "shell.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct{
+	uint32_t sent;
+	uint32_t dropped;
+	uint32_t timeouts;		// attentes SHELL_TX_BLOCK abandonnées (octets comptés dans dropped)
+	uint16_t peak;
+} shell_tx_stats_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported macros -----------------------------------------------------------*/
+// 1 : ancien comportement, commandes exécutées dans l'ISR uart (mesure avant/après)
+#ifndef SHELL_EXEC_IN_ISR
+#define SHELL_EXEC_IN_ISR 0
+#endif
+
+// Politique quand la file d'émission est pleine
+#define SHELL_TX_DROP 0		// octets perdus et comptés
+#define SHELL_TX_BLOCK 1	// attente, hors ISR uniquement (drop sinon)
+#ifndef SHELL_TX_POLICY
+#define SHELL_TX_POLICY SHELL_TX_BLOCK
+#endif
+// Attente maximale sans place libérée avant de perdre la fin de l'écriture
+// (file pleine vidée en ~90 ms à 115200 bauds)
+#ifndef SHELL_TX_BLOCK_TIMEOUT_MS
+#define SHELL_TX_BLOCK_TIMEOUT_MS 200
+#endif
+/* End of exported macros ----------------------------------------------------*/
+
+/* External variables --------------------------------------------------------*/
+extern const shell_io_t shell_uart_io;
+/* End of external variables -------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+void uart_init(UART_HandleTypeDef * huart);
+int uart_read(char * ch);
+int uart_write(char * s, uint16_t size);
+uint16_t uart_tx_free();
+void uart_tx_set_policy(uint8_t policy);
+void uart_tx_get_stats(shell_tx_stats_t * stats);
+void uart_rx_event(UART_HandleTypeDef * huart, uint16_t size);
+uint32_t uart_rx_overflow();
+uint32_t uart_rx_errors();
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_SHELL_UART_H_ */
@@ -0,0 +1,105 @@
+/**
+ ******************************************************************************
+ * @file	sysid.h
+ * @brief	Identification d'un moteur à courant continu : excitation SBPA et
+ *			moindres carrés
+ ******************************************************************************
+ *
+ * Excitation : séquence binaire pseudo-aléatoire (SBPA, LFSR 15 bits de
+ * longueur maximale), chaque bit tenu hold périodes. Spectre plat jusqu'à
+ * environ f_e / (2.hold).
+ *
+ * Modèle : L.di/dt = Vbus.u - R.i - ke.w et J.dw/dt = ke.i - f.w.
+ * Les échantillons (u, i, pas codeur) sont fournis dans l'ordre par
+ * sysid_add(), qui accumule les équations normales de deux régressions :
+ *  - électrique, à chaque période : i[k] = a.i[k-1] + b.u + c.w[k-1], u
+ *    moyenne des deux commandes appliquées entre les échantillons k-1 et k
+ *    (CCR préchargés : la commande lue en k s'applique en k+1), w moyenne
+ *    des pas codeur sur SYSID_W_WINDOW périodes centrée sur k-1 (la
+ *    régression est retardée d'une demi-fenêtre) ;
+ *  - mécanique, par blocs de block périodes : w[n] = d.w[n-1] + e.i[n-1].
+ * Aucun tableau d'échantillons n'est nécessaire. sysid_solve() en déduit R,
+ * L, ke, J, f et le coefficient de détermination de chaque régression.
+ *
+ * Aucune dépendance à la HAL : le même code s'exécute sur la carte, sur les
+ * données capturées en RAM, et sur PC contre des données simulées.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_SYSID_H_
+#define INC_SYSID_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported macros -----------------------------------------------------------*/
+#define SYSID_MAX_PARAMS 3
+#define SYSID_W_WINDOW 16			// périodes, puissance de 2
+/* End of exported macros ----------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct{
+	uint16_t lfsr;
+	uint16_t hold;				// périodes par bit
+	uint16_t count;
+	int8_t bit;					// +1 / -1
+} prbs_t;
+
+// Moindres carrés par équations normales (double : précision sur quelques milliers d'échantillons)
+typedef struct{
+	uint8_t p;
+	uint32_t n;
+	double a[SYSID_MAX_PARAMS][SYSID_MAX_PARAMS];
+	double b[SYSID_MAX_PARAMS];
+	double yy;
+	double y;
+} ls_t;
+
+typedef struct{
+	float r;					// Ohm
+	float l;					// H
+	float ke;					// V.s/rad (= N.m/A)
+	float j;					// kg.m²
+	float f;					// N.m.s/rad
+	float r2_elec;				// qualité de l'ajustement, 1 : parfait
+	float r2_mech;
+} sysid_result_t;
+
+typedef struct{
+	float te;					// période d'échantillonnage (s)
+	float vbus;					// V
+	float rad_per_tick;
+	uint16_t block;				// périodes par bloc mécanique
+
+	ls_t elec;
+	ls_t mech;
+
+	uint32_t k;					// échantillons reçus
+	float u_hist[SYSID_W_WINDOW];	// derniers échantillons, indice k % SYSID_W_WINDOW
+	float i_hist[SYSID_W_WINDOW];
+	int16_t w_hist[SYSID_W_WINDOW];
+	int32_t w_sum;				// pas sur la fenêtre
+
+	uint16_t blk_count;
+	float blk_i;
+	int32_t blk_ticks;
+	float blk_i_prev;
+	float blk_w_prev;
+	uint32_t blk_n;
+} sysid_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+void prbs_init(prbs_t * prbs, uint16_t hold);
+int8_t prbs_next(prbs_t * prbs);
+
+void ls_init(ls_t * ls, uint8_t p);
+void ls_add(ls_t * ls, const float * x, float y);
+int ls_solve(const ls_t * ls, float * theta, float * r2);
+
+void sysid_init(sysid_t * id, float te, float vbus, uint32_t ticks_per_rev, uint16_t block);
+void sysid_add(sysid_t * id, float u, float i, int16_t ticks);
+int sysid_solve(const sysid_t * id, sysid_result_t * res);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_SYSID_H_ */
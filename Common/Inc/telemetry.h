@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ * @file	telemetry.h
+ * @brief	Télémétrie : file d'enregistrements sans verrou et trames binaires
+ ******************************************************************************
+ *
+ * Les interruptions de commande produisent des enregistrements de taille fixe
+ * (horodatage + TELEM_CHANNELS voies int32) jusqu'à la fréquence MLI. La
+ * décimation est appliquée à l'écriture : telem_begin() renvoie NULL pour les
+ * appels sautés, la file ne contient que les enregistrements à émettre.
+ *
+ * File SPSC : un seul producteur (ISR) avance head, la boucle principale
+ * avance tail. Un enregistrement produit alors que la file est pleine est
+ * perdu et compté. telem_process() regroupe les enregistrements dans des
+ * trames, ne garde que les voies du masque et les confie à une fonction
+ * d'émission, qui peut refuser la trame (liaison occupée) : elle sera
+ * réessayée au prochain appel. Aucune dépendance à la HAL.
+ *
+ * Trame : masque (uint8), nombre d'enregistrements (uint8), puis pour chacun
+ * l'horodatage (uint32) et les voies sélectionnées (int32), little-endian.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_TELEMETRY_H_
+#define INC_TELEMETRY_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported macros -----------------------------------------------------------*/
+#define TELEM_CHANNELS 8			// voies par enregistrement (8 au plus, masque uint8)
+#define TELEM_RING_SIZE 128			// enregistrements, puissance de 2
+/* End of exported macros ----------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct{
+	uint32_t t;
+	int32_t ch[TELEM_CHANNELS];
+} telem_record_t;
+
+// Émission d'une trame : 0 si acceptée, -1 pour réessayer plus tard
+typedef int (* telem_send_t)(const uint8_t * data, uint16_t len);
+
+typedef struct{
+	uint32_t produced;			// enregistrements écrits dans la file
+	uint32_t dropped;			// perdus, file pleine
+	uint32_t sent;				// enregistrements émis
+	uint32_t frames;			// trames émises
+	uint32_t busy;				// trames refusées par la liaison
+	uint16_t peak;				// remplissage maximal de la file
+} telem_stats_t;
+
+typedef struct{
+	telem_record_t ring[TELEM_RING_SIZE];
+	volatile uint16_t head;		// producteur
+	volatile uint16_t tail;		// consommateur
+	volatile uint16_t decimation;	// 1 enregistrement tous les n appels, 0 : arrêt
+	volatile uint8_t mask;		// voies émises
+	uint16_t count;				// compteur de décimation (producteur)
+
+	volatile uint32_t produced;
+	volatile uint32_t dropped;
+	volatile uint16_t peak;
+	uint32_t sent;
+	uint32_t frames;
+	uint32_t busy;
+} telem_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+void telem_init(telem_t * telem);
+void telem_config(telem_t * telem, uint8_t mask, uint16_t decimation);
+telem_record_t * telem_begin(telem_t * telem);
+void telem_commit(telem_t * telem);
+uint16_t telem_process(telem_t * telem, telem_send_t send, uint16_t max_len);
+void telem_get_stats(const telem_t * telem, telem_stats_t * stats);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_TELEMETRY_H_ */
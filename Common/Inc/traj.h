@@ -0,0 +1,85 @@
+/**
+ ******************************************************************************
+ * @file	traj.h
+ * @brief	Générateur de trajectoire trapèze / S-curve en virgule fixe
+ ******************************************************************************
+ *
+ * Unités internes : pas codeur et période d'échantillonnage (tick). Position,
+ * vitesse, accélération et jerk sont en Q32.32 (int64_t) : pas, pas/tick,
+ * pas/tick², pas/tick³.
+ *
+ * Un mouvement est planifié hors ISR (traj_move_pos, traj_move_vel) en au
+ * plus 7 phases à jerk constant de durée entière, puis mis en file. À chaque
+ * tick, traj_tick() ajoute jerk, accélération et vitesse : O(1), trois
+ * additions 64 bits, ni division ni flottant. Avec des phases de décélération
+ * miroir de l'accélération, la distance d'un mouvement point à point vaut
+ * exactement v.(n_acc + n_croisière) : la vitesse de croisière est choisie
+ * pour tomber sur la cible, l'arrondi résiduel (< 1 pas) est recalé en fin.
+ *
+ * jmax = 0 : profil trapèze (accélération en échelon). Un mouvement en
+ * vitesse se termine sur la vitesse cible, maintenue jusqu'au suivant.
+ * Au-delà de ±2^31 pas, la position tourne modulo 2^32 pas : l'écart avec
+ * la position mesurée se calcule sur les parties entières modulo 2^32.
+ * File SPSC : la planification écrit head, l'ISR avance tail.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_TRAJ_H_
+#define INC_TRAJ_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported macros -----------------------------------------------------------*/
+#define TRAJ_QUEUE_SIZE 8		// puissance de 2
+#define TRAJ_ONE ((int64_t)1 << 32)
+/* End of exported macros ----------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct{
+	int64_t jerk;
+	uint32_t ticks;
+} traj_phase_t;
+
+typedef struct{
+	traj_phase_t phase[7];
+	uint8_t n;
+	int64_t end_pos;			// recalage en fin de mouvement
+	int64_t end_vel;
+	uint8_t end_pos_valid;		// 0 : mouvement en vitesse, position libre
+} traj_move_t;
+
+typedef struct{
+	// Limites (pas/tick, pas/tick², pas/tick³), jmax = 0 : trapèze
+	float vmax;
+	float amax;
+	float jmax;
+
+	// File de mouvements planifiés
+	traj_move_t queue[TRAJ_QUEUE_SIZE];
+	volatile uint8_t head;
+	volatile uint8_t tail;
+	int64_t plan_pos;			// état en fin de file
+	int64_t plan_vel;
+	uint8_t plan_pos_valid;
+
+	// État courant (ISR)
+	volatile uint8_t busy;		// mouvement en cours
+	uint8_t phase;
+	uint32_t left;
+	int64_t pos;
+	int64_t vel;
+	int64_t acc;
+} traj_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+void traj_init(traj_t * t, int64_t pos, int64_t vel);
+void traj_set_limits(traj_t * t, float vmax, float amax, float jmax);
+int traj_move_pos(traj_t * t, int64_t target);
+int traj_move_vel(traj_t * t, int64_t target);
+void traj_tick(traj_t * t);
+uint8_t traj_idle(const traj_t * t);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_TRAJ_H_ */
@@ -0,0 +1,58 @@
+/**
+ ******************************************************************************
+ * @file	velocity.h
+ * @brief	Estimation de vitesse par méthode M/T (pas codeur et date des fronts)
+ ******************************************************************************
+ *
+ * Méthode M (pas comptés par période) : résolution 2.pi.fe/N, inutilisable à
+ * basse vitesse. Méthode M/T : la fenêtre de mesure s'étend d'un front codeur
+ * au premier front qui suit le tick d'échantillonnage, w = dN.2.pi/(N.dT) avec
+ * dN et dT exacts aux fronts. La résolution est alors celle de l'horloge de
+ * datation, à toutes les vitesses.
+ *
+ * Sans nouveau front depuis le tick précédent, la vitesse est bornée par
+ * edge_ticks / (maintenant - dernier front) et tombe à 0 après timeout.
+ * Un passe-bas du premier ordre optionnel (vel_set_filter) lisse la sortie.
+ *
+ * vel_capture() (front) et vel_update() (tick) ne doivent pas s'interrompre
+ * mutuellement : la capture est désarmée au front, et par le tick pendant
+ * vel_update() avant d'être réarmée. La capture doit être plus prioritaire
+ * que le tick et que les autres ISR longues : son retard s'ajoute à dT.
+ * Aucune dépendance à la HAL.
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef INC_VELOCITY_H_
+#define INC_VELOCITY_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct{
+	float rad_per_tick_s;		// 2.pi.f_clk / N : w = dN / dT * rad_per_tick_s
+	uint32_t edge_ticks;		// pas entre deux fronts capturés
+	uint32_t timeout;			// durée sans front au-delà de laquelle w = 0 (périodes d'horloge)
+	float alpha;				// passe-bas : 1 = pas de filtre
+
+	uint32_t cap_cnt;			// dernière capture publiée par vel_capture()
+	uint32_t cap_t;
+	volatile uint8_t cap_ready;
+
+	uint32_t edge_cnt;			// dernier front utilisé
+	uint32_t edge_t;
+	uint8_t edge_valid;
+
+	float w_raw;				// dernière mesure M/T (rad/s)
+	float w;					// sortie filtrée (rad/s)
+} vel_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+void vel_init(vel_t * vel, uint32_t ticks_per_rev, uint32_t edge_ticks, uint32_t clk_hz, float timeout_s);
+void vel_set_filter(vel_t * vel, float cutoff_hz, float sample_hz);
+void vel_capture(vel_t * vel, uint32_t cnt, uint32_t t);
+float vel_update(vel_t * vel, uint32_t now);
+/* End of exported functions -------------------------------------------------*/
+
+#endif /* INC_VELOCITY_H_ */
@@ -0,0 +1,130 @@
+/**
+ ******************************************************************************
+ * @file	autotune.c
+ * @brief	Réglage automatique d'un PI par essai au relais (Åström-Hägglund)
+ ******************************************************************************
+ */
+
+#include "autotune.h"
+
+#include <string.h>
+#include <math.h>
+
+/* Macros --------------------------------------------------------------------*/
+#define AT_SKIP 2					// cycles de transitoire
+#define AT_CYCLES 4					// cycles moyennés
+/* End of macros -------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+/**
+ * @brief	Préparation d'un essai (hors ISR, avant de confier la sortie à at_update)
+ * @param	at Essai
+ * @param	ref Consigne autour de laquelle la mesure oscille
+ * @param	u0 Commande au repos (centre du relais)
+ * @param	d Amplitude du relais
+ * @param	eps Hystérésis, au-dessus du bruit de mesure
+ * @param	te Période d'appel de at_update() (s)
+ * @param	timeout_s Durée maximale de l'essai (s)
+ */
+void at_start(at_t * at, float ref, float u0, float d, float eps, float te, float timeout_s) {
+	memset(at, 0, sizeof(*at));
+	at->ref = ref;
+	at->u0 = u0;
+	at->d = d;
+	at->eps = eps;
+	at->te = te;
+	at->skip = AT_SKIP;
+	at->cycles = AT_CYCLES;
+	at->timeout = (uint32_t)(timeout_s / te);
+	at->state = AT_RUNNING;
+}
+
+/**
+ * @brief	Une période de l'essai (ISR de la boucle réglée)
+ * @param	at Essai
+ * @param	y Mesure
+ * @retval	Commande à appliquer, u0 une fois l'essai terminé
+ */
+float at_update(at_t * at, float y) {
+	if (at->state != AT_RUNNING) return at->u0;
+
+	float e = at->ref - y;
+
+	if (at->n == 0) {
+		at->sign = (e >= 0.0f) ? 1 : -1;
+		at->y_max = y;
+		at->y_min = y;
+	}
+	at->n++;
+
+	if (y > at->y_max) at->y_max = y;
+	if (y < at->y_min) at->y_min = y;
+
+	if (at->sign > 0 && e < -at->eps) {
+		at->sign = -1;
+	}
+	else if (at->sign < 0 && e > at->eps) {
+		// Passage en relais haut : fin d'un cycle complet
+		at->sign = 1;
+
+		if (at->rises > at->skip) {
+			at->sum_period += (float)(at->n - at->last_rise);
+			at->sum_amplitude += 0.5f * (at->y_max - at->y_min);
+		}
+		at->rises++;
+		at->last_rise = at->n;
+		at->y_max = y;
+		at->y_min = y;
+
+		if (at->rises > at->skip + at->cycles) {
+			float a = at->sum_amplitude / at->cycles;
+
+			at->tu = at->sum_period / at->cycles * at->te;
+			at->a = a;
+			if (a > at->eps) {
+				at->ku = 4.0f * at->d / ((float)M_PI * sqrtf(a * a - at->eps * at->eps));
+				at->state = AT_DONE;
+			}
+			else {
+				at->state = AT_FAILED;
+			}
+			return at->u0;
+		}
+	}
+
+	if (at->n >= at->timeout) {
+		at->state = AT_FAILED;
+		return at->u0;
+	}
+
+	return at->u0 + at->sign * at->d;
+}
+
+/**
+ * @brief	Gains PI déduits de l'essai
+ * @param	at Essai terminé
+ * @param	rule AT_RULE_ZN ou AT_RULE_TL
+ * @param	kp Gain proportionnel
+ * @param	ki Gain intégral (1/s), ki = kp / Ti
+ * @retval	0, -1 si l'essai n'a pas abouti
+ */
+int at_gains(const at_t * at, uint8_t rule, float * kp, float * ki) {
+	float ti;
+
+	if (at->state != AT_DONE || at->tu <= 0.0f) return -1;
+
+	if (rule == AT_RULE_ZN) {
+		*kp = 0.45f * at->ku;
+		ti = at->tu / 1.2f;
+	}
+	else {
+		*kp = at->ku / 3.2f;
+		ti = 2.2f * at->tu;
+	}
+	*ki = *kp / ti;
+
+	return 0;
+}
+
+/* End of functions ----------------------------------------------------------*/
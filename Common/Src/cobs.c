@@ -0,0 +1,170 @@
+/**
+ ******************************************************************************
+ * @file	cobs.c
+ * @brief	Trames binaires : codage COBS et CRC-16/CCITT-FALSE
+ ******************************************************************************
+ */
+
+#include "cobs.h"
+
+/* Types ---------------------------------------------------------------------*/
+// Codage COBS au fil de l'eau, sans copie du message
+typedef struct{
+	uint8_t * dst;
+	uint16_t code_pos;
+	uint16_t out;
+	uint8_t code;
+} cobs_stream_t;
+/* End of types --------------------------------------------------------------*/
+
+/* Constants -----------------------------------------------------------------*/
+// CRC-16/CCITT-FALSE, table par quartet (32 octets de flash)
+static const uint16_t crc16_table[16] = {
+		0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+		0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+/* End of constants ----------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+/**
+ * @brief	CRC-16/CCITT-FALSE
+ * @param	data Octets
+ * @param	len Nombre d'octets
+ * @param	crc COBS_CRC_INIT, ou CRC des octets précédents
+ * @retval	CRC
+ */
+uint16_t cobs_crc16(const uint8_t * data, uint16_t len, uint16_t crc) {
+	for (uint16_t i = 0 ; i < len ; i++) {
+		crc = (crc << 4) ^ crc16_table[(crc >> 12) ^ (data[i] >> 4)];
+		crc = (crc << 4) ^ crc16_table[(crc >> 12) ^ (data[i] & 0x0F)];
+	}
+	return crc;
+}
+
+static void stream_init(cobs_stream_t * s, uint8_t * dst) {
+	s->dst = dst;
+	s->code_pos = 0;
+	s->out = 1;
+	s->code = 1;
+}
+
+static void stream_put(cobs_stream_t * s, uint8_t b) {
+	if (b == 0) {
+		s->dst[s->code_pos] = s->code;
+		s->code_pos = s->out++;
+		s->code = 1;
+	}
+	else {
+		s->dst[s->out++] = b;
+		s->code++;
+		if (s->code == 0xFF) {
+			s->dst[s->code_pos] = s->code;
+			s->code_pos = s->out++;
+			s->code = 1;
+		}
+	}
+}
+
+static uint16_t stream_end(cobs_stream_t * s) {
+	s->dst[s->code_pos] = s->code;
+	return s->out;
+}
+
+/**
+ * @brief	Codage COBS
+ * @param	src Octets
+ * @param	len Nombre d'octets
+ * @param	dst Au moins COBS_ENCODED_MAX_SIZE(len) octets, sans 0x00
+ * @retval	Octets écrits
+ */
+uint16_t cobs_encode(const uint8_t * src, uint16_t len, uint8_t * dst) {
+	cobs_stream_t s;
+
+	stream_init(&s, dst);
+	for (uint16_t i = 0 ; i < len ; i++) {
+		stream_put(&s, src[i]);
+	}
+
+	return stream_end(&s);
+}
+
+/**
+ * @brief	Décodage COBS
+ * @param	src Octets reçus entre deux délimiteurs
+ * @param	len Nombre d'octets
+ * @param	dst Au moins len octets
+ * @retval	Octets décodés, -1 si le codage est invalide
+ */
+int cobs_decode(const uint8_t * src, uint16_t len, uint8_t * dst) {
+	uint16_t in = 0;
+	uint16_t out = 0;
+
+	while (in < len) {
+		uint8_t code = src[in++];
+
+		if (code == 0) return -1;
+
+		for (uint8_t j = 1 ; j < code ; j++) {
+			if (in >= len) return -1;
+			dst[out++] = src[in++];
+		}
+		if (code != 0xFF && in < len) {
+			dst[out++] = 0;
+		}
+	}
+
+	return out;
+}
+
+/**
+ * @brief	Trame complète : délimiteurs, COBS, type, seq, données et CRC
+ * @param	type Type de message
+ * @param	seq Numéro de séquence
+ * @param	data Données
+ * @param	len Nombre d'octets de données
+ * @param	dst Au moins COBS_FRAME_MAX_SIZE(len) octets
+ * @retval	Longueur de la trame
+ */
+uint16_t cobs_frame_encode(uint8_t type, uint8_t seq, const uint8_t * data, uint16_t len, uint8_t * dst) {
+	cobs_stream_t s;
+	uint8_t head[2] = {type, seq};
+	uint16_t crc = cobs_crc16(data, len, cobs_crc16(head, 2, COBS_CRC_INIT));
+
+	dst[0] = 0;
+	stream_init(&s, &dst[1]);
+	stream_put(&s, type);
+	stream_put(&s, seq);
+	for (uint16_t i = 0 ; i < len ; i++) {
+		stream_put(&s, data[i]);
+	}
+	stream_put(&s, crc & 0xFF);
+	stream_put(&s, crc >> 8);
+
+	uint16_t n = stream_end(&s);
+	dst[n + 1] = 0;
+
+	return n + 2;
+}
+
+/**
+ * @brief	Décodage et vérification d'une trame
+ * @param	src Octets reçus entre les deux délimiteurs
+ * @param	len Nombre d'octets
+ * @param	msg Au moins len octets : type, seq, données, CRC
+ * @retval	Nombre d'octets de données (à partir de msg + 2),
+ *			COBS_ERR_CODING ou COBS_ERR_CRC
+ */
+int cobs_frame_decode(const uint8_t * src, uint16_t len, uint8_t * msg) {
+	int n = cobs_decode(src, len, msg);
+
+	if (n < 4) return COBS_ERR_CODING;
+
+	uint16_t crc = msg[n - 2] | (msg[n - 1] << 8);
+
+	if (cobs_crc16(msg, n - 2, COBS_CRC_INIT) != crc) return COBS_ERR_CRC;
+
+	return n - 4;
+}
+
+/* End of functions ----------------------------------------------------------*/
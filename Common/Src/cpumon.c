@@ -0,0 +1,156 @@
+/**
+ ******************************************************************************
+ * @file	cpumon.c
+ * @brief	Charge CPU par comptage de la boucle d'attente et gigue des
+ *			interruptions périodiques
+ ******************************************************************************
+ */
+
+#include "cpumon.h"
+
+#include <string.h>
+
+/* Functions -----------------------------------------------------------------*/
+
+/**
+ * @brief	Initialisation, sans étalonnage (charge nulle jusqu'à cpuload_calibrate)
+ * @param	l Mesure
+ * @param	threshold Seuil d'alerte, pour mille
+ */
+void cpuload_init(cpuload_t * l, uint16_t threshold) {
+	memset(l, 0, sizeof(*l));
+	l->threshold = threshold;
+}
+
+/**
+ * @brief	Un tour de la boucle principale sans travail
+ * @param	l Mesure
+ */
+void cpuload_idle(cpuload_t * l) {
+	l->idle++;
+}
+
+/**
+ * @brief	Coût d'un tour à vide, puis ouverture de la première fenêtre
+ * @param	l Mesure
+ * @param	cycles Durée de loops tours à vide, interruptions masquées
+ * @param	loops Tours mesurés
+ * @param	now Horloge
+ */
+void cpuload_calibrate(cpuload_t * l, uint32_t cycles, uint32_t loops, uint32_t now) {
+	l->cost = (loops > 0) ? (uint32_t)(((uint64_t)cycles << CPULOAD_COST_SHIFT) / loops) : 0;
+	l->win_start = now;
+	l->win_idle = l->idle;
+}
+
+/**
+ * @brief	Fin de fenêtre : charge, pic et alerte
+ * @param	l Mesure
+ * @param	now Horloge
+ * @retval	Charge de la fenêtre, pour mille
+ */
+uint16_t cpuload_update(cpuload_t * l, uint32_t now) {
+	uint32_t span = now - l->win_start;
+	uint64_t spare = ((uint64_t)(l->idle - l->win_idle) * l->cost) >> CPULOAD_COST_SHIFT;
+
+	l->win_start = now;
+	l->win_idle = l->idle;
+	if (span == 0) return l->load;
+
+	l->load = (spare < span) ? (uint16_t)(CPULOAD_FULL - spare * CPULOAD_FULL / span) : 0;
+	if (l->load > l->peak) l->peak = l->load;
+
+	uint8_t warning = (l->load > l->threshold);
+
+	if (warning && !l->warning) l->warnings++;
+	l->warning = warning;
+
+	return l->load;
+}
+
+/**
+ * @brief	Remise à zéro du pic et des alertes
+ * @param	l Mesure
+ */
+void cpuload_clear(cpuload_t * l) {
+	l->peak = l->load;
+	l->warnings = 0;
+}
+
+static void jitter_clear(jitter_t * j) {
+	j->started = 0;
+	j->n = 0;
+	j->dev_last = 0;
+	j->dev_min = INT32_MAX;
+	j->dev_max = INT32_MIN;
+	j->abs_sum = 0;
+	j->gaps = 0;
+	memset(j->hist, 0, sizeof(j->hist));
+}
+
+/**
+ * @brief	Initialisation
+ * @param	j Mesure
+ * @param	period Période nominale, unités de l'horloge
+ */
+void jitter_init(jitter_t * j, uint32_t period) {
+	j->period = period;
+	j->req_reset = 0;
+	jitter_clear(j);
+}
+
+/**
+ * @brief	Entrée de l'ISR (écrivain unique)
+ * @param	j Mesure
+ * @param	now Horloge
+ */
+void jitter_stamp(jitter_t * j, uint32_t now) {
+	if (j->req_reset) {
+		jitter_clear(j);
+		j->req_reset = 0;
+	}
+
+	uint32_t dt = now - j->last;
+
+	j->last = now;
+	if (!j->started) {
+		j->started = 1;
+		return;
+	}
+	if (dt >= 2 * j->period) {
+		j->gaps++;
+		return;
+	}
+
+	int32_t dev = (int32_t)(dt - j->period);
+	uint32_t mag = (dev < 0) ? -dev : dev;
+	uint32_t bin = (mag > 0) ? 31 - __builtin_clz(mag) : 0;
+
+	if (bin >= JITTER_HIST_BINS) bin = JITTER_HIST_BINS - 1;
+	j->hist[bin]++;
+
+	j->dev_last = dev;
+	if (dev < j->dev_min) j->dev_min = dev;
+	if (dev > j->dev_max) j->dev_max = dev;
+	j->abs_sum += mag;
+	j->n++;
+}
+
+/**
+ * @brief	Demande de remise à zéro, appliquée à l'entrée suivante
+ * @param	j Mesure
+ */
+void jitter_reset(jitter_t * j) {
+	j->req_reset = 1;
+}
+
+/**
+ * @brief	Écart absolu moyen
+ * @param	j Mesure (copie cohérente de préférence)
+ * @retval	Unités de l'horloge, 0 sans mesure
+ */
+uint32_t jitter_mean(const jitter_t * j) {
+	return (j->n > 0) ? (uint32_t)(j->abs_sum / j->n) : 0;
+}
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,90 @@
+/**
+ ******************************************************************************
+ * @file	encoder.c
+ * @brief	Position codeur absolue à partir d'un compteur 32 bits libre
+ ******************************************************************************
+ */
+
+#include "encoder.h"
+
+#include <string.h>
+
+/* Macros --------------------------------------------------------------------*/
+// Barrière compilateur : ordre des écritures tampon / publication (mono-cœur)
+#define ENC_BARRIER() __asm volatile ("" ::: "memory")
+/* End of macros -------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+/**
+ * @brief	Initialisation, la position courante devient l'origine
+ * @param	enc Codeur
+ * @param	cnt Valeur actuelle du compteur
+ * @param	ticks_per_rev Pas par tour (non nul)
+ */
+void enc_init(enc_t * enc, uint32_t cnt, uint32_t ticks_per_rev) {
+	memset(enc, 0, sizeof(*enc));
+	enc->ticks_per_rev = ticks_per_rev;
+	enc->last_cnt = cnt;
+}
+
+/**
+ * @brief	Nouvel échantillon du compteur (écrivain unique, typiquement en ISR)
+ * @param	enc Codeur
+ * @param	cnt Valeur actuelle du compteur
+ * @retval	Pas depuis l'échantillon précédent
+ */
+int32_t enc_update(enc_t * enc, uint32_t cnt) {
+	uint32_t seq = enc->seq;
+	const enc_snapshot_t * cur = &enc->snap[seq & 1];
+	enc_snapshot_t * next = &enc->snap[(seq + 1) & 1];
+	int32_t delta = (int32_t)(cnt - enc->last_cnt);
+	int32_t tpr = enc->ticks_per_rev;
+
+	enc->last_cnt = cnt;
+
+	// Tours et angle en 32 bits, sans division 64 bits en ISR
+	int32_t revolutions = cur->revolutions + delta / tpr;
+	int32_t angle = (int32_t)cur->angle + delta % tpr;
+
+	if (angle >= tpr) {
+		angle -= tpr;
+		revolutions++;
+	}
+	else if (angle < 0) {
+		angle += tpr;
+		revolutions--;
+	}
+
+	next->position = cur->position + delta;
+	next->revolutions = revolutions;
+	next->angle = angle;
+	next->delta = delta;
+	next->samples = cur->samples + 1;
+
+	ENC_BARRIER();
+	enc->seq = seq + 1;
+
+	return delta;
+}
+
+/**
+ * @brief	Copie cohérente du dernier échantillon publié
+ * @param	enc Codeur
+ * @param	snap Destination
+ * @note	Ne masque pas les interruptions. Un lecteur plus prioritaire que
+ *			l'écrivain ne recommence jamais, un lecteur moins prioritaire
+ *			recommence au plus une fois par période d'échantillonnage.
+ */
+void enc_get(const enc_t * enc, enc_snapshot_t * snap) {
+	uint32_t seq;
+
+	do {
+		seq = enc->seq;
+		ENC_BARRIER();
+		*snap = enc->snap[seq & 1];
+		ENC_BARRIER();
+	} while (enc->seq != seq);
+}
+
+/* End of functions ----------------------------------------------------------*/
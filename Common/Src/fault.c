@@ -0,0 +1,69 @@
+/**
+ ******************************************************************************
+ * @file	fault.c
+ * @brief	Verrouillage des défauts matériels (surintensité...)
+ ******************************************************************************
+ */
+
+#include "fault.h"
+
+#include <string.h>
+
+/* Macros --------------------------------------------------------------------*/
+// Barrière compilateur : enregistrement écrit avant la source (mono-cœur)
+#define FAULT_BARRIER() __asm volatile ("" ::: "memory")
+/* End of macros -------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+/**
+ * @brief	Initialisation, aucun défaut
+ */
+void fault_init(fault_t * fault) {
+	memset(fault, 0, sizeof(*fault));
+}
+
+/**
+ * @brief	Déclenchement (ISR, puissance déjà coupée)
+ * @param	fault Défaut
+ * @param	source FAULT_OVERCURRENT...
+ * @param	channel Voie en cause
+ * @param	value Grandeur mesurée
+ * @param	cycles Horodatage (cycles CPU)
+ * @param	tick Horodatage (ms)
+ * @retval	1 si ce déclenchement est verrouillé, 0 si un défaut l'était déjà
+ */
+int fault_trip(fault_t * fault, uint8_t source, uint8_t channel, int32_t value, uint32_t cycles, uint32_t tick) {
+	fault->trips++;
+	if (fault->source != FAULT_NONE) return 0;
+
+	fault->channel = channel;
+	fault->value = value;
+	fault->cycles = cycles;
+	fault->tick = tick;
+	FAULT_BARRIER();
+	fault->source = source;
+
+	return 1;
+}
+
+/**
+ * @brief	Réarmement (boucle principale, cause supprimée)
+ * @retval	0, -1 si aucun défaut n'était verrouillé
+ */
+int fault_rearm(fault_t * fault) {
+	if (fault->source == FAULT_NONE) return -1;
+
+	fault->source = FAULT_NONE;
+
+	return 0;
+}
+
+/**
+ * @brief	Source du défaut verrouillé, FAULT_NONE si aucun
+ */
+uint8_t fault_latched(const fault_t * fault) {
+	return fault->source;
+}
+
+/* End of functions ----------------------------------------------------------*/
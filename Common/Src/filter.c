@@ -0,0 +1,90 @@
+/**
+ ******************************************************************************
+ * @file	filter.c
+ * @brief	Filtres numériques en virgule fixe pour mesures 16 bits
+ ******************************************************************************
+ */
+
+#include "filter.h"
+
+#include <string.h>
+
+/* Macros --------------------------------------------------------------------*/
+// Barrière compilateur : paramètres écrits avant la demande (mono-cœur)
+#define FILT_BARRIER() __asm volatile ("" ::: "memory")
+/* End of macros -------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+/**
+ * @brief	Initialisation, sans filtrage
+ * @param	f Filtre
+ */
+void filt_init(filt_t * f) {
+	memset(f, 0, sizeof(*f));
+	f->type = FILT_NONE;
+}
+
+/**
+ * @brief	Demande de changement de filtre (boucle principale)
+ * @param	f Filtre
+ * @param	type FILT_NONE, FILT_IIR ou FILT_MA
+ * @param	order 1..FILT_IIR_MAX_ORDER (IIR), 1..FILT_MA_MAX_ORDER (MA)
+ * @retval	0, -1 si le couple type / ordre est invalide
+ */
+int filt_config(filt_t * f, uint8_t type, uint8_t order) {
+	if (type == FILT_IIR && (order < 1 || order > FILT_IIR_MAX_ORDER)) return -1;
+	if (type == FILT_MA && (order < 1 || order > FILT_MA_MAX_ORDER)) return -1;
+	if (type > FILT_MA) return -1;
+
+	f->req_type = type;
+	f->req_order = order;
+	FILT_BARRIER();
+	f->req = 1;
+
+	return 0;
+}
+
+/**
+ * @brief	Un échantillon (ISR, écrivain unique de l'état)
+ * @param	f Filtre
+ * @param	x Mesure
+ * @retval	Mesure filtrée, même échelle que x
+ */
+uint16_t filt_update(filt_t * f, uint16_t x) {
+	if (f->req) {
+		// Changement appliqué ici : l'état repart de x
+		f->type = f->req_type;
+		f->order = f->req_order;
+		f->req = 0;
+
+		if (f->type == FILT_IIR) {
+			f->acc = (int32_t)x << 8;
+		}
+		else if (f->type == FILT_MA) {
+			for (uint8_t i = 0 ; i < (1 << f->order) ; i++) f->hist[i] = x;
+			f->acc = (int32_t)x << f->order;
+			f->idx = 0;
+		}
+	}
+
+	switch (f->type) {
+	case FILT_IIR:
+		f->acc += (((int32_t)x << 8) - f->acc) >> f->order;
+		return (uint16_t)((f->acc + 128) >> 8);
+
+	case FILT_MA: {
+		uint8_t mask = (1 << f->order) - 1;
+
+		f->acc += x - f->hist[f->idx];
+		f->hist[f->idx] = x;
+		f->idx = (f->idx + 1) & mask;
+		return (uint16_t)((f->acc + (1 << (f->order - 1))) >> f->order);
+	}
+
+	default:
+		return x;
+	}
+}
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,211 @@
+/**
+ ******************************************************************************
+ * @file	fmt.c
+ * @brief	Formatage entier et virgule fixe, sans allocation ni flottant
+ ******************************************************************************
+ */
+
+#include "fmt.h"
+
+#include <stddef.h>
+
+/* Constants -----------------------------------------------------------------*/
+static const uint32_t pow10[] = {
+		1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+/* End of constants ----------------------------------------------------------*/
+
+/* Variables -----------------------------------------------------------------*/
+static fmt_write_t fmt_write = NULL;
+/* End of variables ----------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+/**
+ * @brief	Écriture d'un entier non signé en décimal
+ * @param	dst Buffer d'au moins FMT_I32_MAX_SIZE octets
+ * @param	v Valeur
+ * @retval	Nombre de caractères écrits (hors '\0')
+ */
+int fmt_u32(char * dst, uint32_t v) {
+	char tmp[10];
+	int n = 0;
+	int len = 0;
+
+	do {
+		tmp[n++] = '0' + v % 10;
+		v /= 10;
+	} while (v);
+
+	while (n) {
+		dst[len++] = tmp[--n];
+	}
+	dst[len] = '\0';
+
+	return len;
+}
+
+/**
+ * @brief	Écriture d'un entier signé en décimal
+ * @param	dst Buffer d'au moins FMT_I32_MAX_SIZE octets
+ * @param	v Valeur
+ * @retval	Nombre de caractères écrits (hors '\0')
+ */
+int fmt_i32(char * dst, int32_t v) {
+	if (v < 0) {
+		dst[0] = '-';
+		return 1 + fmt_u32(dst + 1, -(uint32_t)v);
+	}
+	return fmt_u32(dst, v);
+}
+
+/**
+ * @brief	Écriture d'une valeur en virgule fixe décimale
+ * @param	dst Buffer d'au moins FMT_FIXED_MAX_SIZE octets
+ * @param	v Valeur multipliée par 10^decimals (ex : 1234 avec 2 -> "12.34")
+ * @param	decimals Nombre de décimales (0 à 9)
+ * @retval	Nombre de caractères écrits (hors '\0')
+ */
+int fmt_fixed(char * dst, int32_t v, uint8_t decimals) {
+	uint32_t a = (v < 0) ? -(uint32_t)v : (uint32_t)v;
+	int len = 0;
+
+	if (decimals > 9) decimals = 9;
+	if (v < 0) dst[len++] = '-';
+
+	len += fmt_u32(&dst[len], a / pow10[decimals]);
+
+	if (decimals) {
+		uint32_t frac = a % pow10[decimals];
+
+		dst[len++] = '.';
+		for (int i = decimals - 1 ; i >= 0 ; i--) {
+			dst[len + i] = '0' + frac % 10;
+			frac /= 10;
+		}
+		len += decimals;
+		dst[len] = '\0';
+	}
+
+	return len;
+}
+
+/**
+ * @brief	Écriture d'une valeur Q16.16 avec arrondi au plus proche
+ * @param	dst Buffer d'au moins FMT_FIXED_MAX_SIZE octets
+ * @param	v Valeur Q16.16 signée
+ * @param	decimals Nombre de décimales (0 à FMT_Q16_MAX_DECIMALS)
+ * @retval	Nombre de caractères écrits (hors '\0')
+ */
+int fmt_q16(char * dst, int32_t v, uint8_t decimals) {
+	uint32_t a = (v < 0) ? -(uint32_t)v : (uint32_t)v;
+	int len = 0;
+
+	if (decimals > FMT_Q16_MAX_DECIMALS) decimals = FMT_Q16_MAX_DECIMALS;
+
+	// 0xFFFF * 10^4 tient sur 32 bits
+	uint32_t ipart = a >> 16;
+	uint32_t frac = ((a & 0xFFFF) * pow10[decimals] + 0x8000) >> 16;
+
+	if (frac >= pow10[decimals]) {
+		ipart++;
+		frac -= pow10[decimals];
+	}
+
+	if (v < 0 && (ipart || frac)) dst[len++] = '-';
+
+	return len + fmt_fixed(&dst[len], ipart * pow10[decimals] + frac, decimals);
+}
+
+/**
+ * @brief	Lecture d'un nombre décimal ("-12.5") en virgule fixe, sans strtod
+ * @param	s Chaîne à lire
+ * @param	decimals Nombre de décimales du résultat (les suivantes sont tronquées)
+ * @param	v Résultat multiplié par 10^decimals
+ * @retval	0 si la chaîne est un nombre valide, -1 sinon
+ */
+int fmt_parse_fixed(const char * s, uint8_t decimals, int32_t * v) {
+	int32_t sign = 1;
+	uint64_t ipart = 0;
+	uint32_t frac = 0;
+	uint8_t nfrac = 0;
+	uint8_t digits = 0;
+
+	if (decimals > 9) return -1;
+
+	if (*s == '-' || *s == '+') {
+		if (*s == '-') sign = -1;
+		s++;
+	}
+	// ipart reste sous 2^31 avant chaque multiplication : pas de débordement sur 64 bits
+	for ( ; *s >= '0' && *s <= '9' ; s++, digits++) {
+		ipart = ipart * 10 + (*s - '0');
+		if (ipart > INT32_MAX) return -1;
+	}
+	if (*s == '.') {
+		for (s++ ; *s >= '0' && *s <= '9' ; s++, digits++) {
+			if (nfrac < decimals) {
+				frac = frac * 10 + (*s - '0');
+				nfrac++;
+			}
+		}
+	}
+	if (*s != '\0' || digits == 0) return -1;
+
+	// Partie entière et décimales ensemble : "21474836.99" déborde avec 2 décimales
+	uint64_t a = ipart * pow10[decimals] + (uint64_t)frac * pow10[decimals - nfrac];
+
+	if (a > INT32_MAX) return -1;
+
+	*v = sign * (int32_t)a;
+	return 0;
+}
+
+/**
+ * @brief	Choix de la sortie des fonctions fmt_put*
+ * @param	write Fonction d'écriture non bloquante (ex : uart_write)
+ */
+void fmt_set_output(fmt_write_t write) {
+	fmt_write = write;
+}
+
+/**
+ * @brief	Écriture d'une chaîne sur la sortie
+ * @param	s Chaîne terminée par '\0'
+ */
+void fmt_puts(const char * s) {
+	uint16_t len = 0;
+
+	while (s[len]) len++;
+	if (fmt_write != NULL) fmt_write((char *)s, len);
+}
+
+void fmt_put_u32(uint32_t v) {
+	char b[FMT_I32_MAX_SIZE];
+	int len = fmt_u32(b, v);
+
+	if (fmt_write != NULL) fmt_write(b, len);
+}
+
+void fmt_put_i32(int32_t v) {
+	char b[FMT_I32_MAX_SIZE];
+	int len = fmt_i32(b, v);
+
+	if (fmt_write != NULL) fmt_write(b, len);
+}
+
+void fmt_put_fixed(int32_t v, uint8_t decimals) {
+	char b[FMT_FIXED_MAX_SIZE];
+	int len = fmt_fixed(b, v, decimals);
+
+	if (fmt_write != NULL) fmt_write(b, len);
+}
+
+void fmt_put_q16(int32_t v, uint8_t decimals) {
+	char b[FMT_FIXED_MAX_SIZE];
+	int len = fmt_q16(b, v, decimals);
+
+	if (fmt_write != NULL) fmt_write(b, len);
+}
+
+/* End of functions ----------------------------------------------------------*/
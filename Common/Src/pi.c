@@ -0,0 +1,75 @@
+/**
+ ******************************************************************************
+ * @file	pi.c
+ * @brief	Régulateur PI discret avec saturation et anti-windup
+ ******************************************************************************
+ */
+
+#include "pi.h"
+
+/* Functions -----------------------------------------------------------------*/
+
+/**
+ * @brief	Initialisation du régulateur, intégrale remise à zéro
+ * @param	pi Régulateur
+ * @param	kp Gain proportionnel
+ * @param	ki Gain intégral (1/s)
+ * @param	te Période d'échantillonnage (s)
+ * @param	out_min Borne basse de la sortie
+ * @param	out_max Borne haute de la sortie
+ */
+void pi_init(pi_t * pi, float kp, float ki, float te, float out_min, float out_max) {
+	pi->kp = kp;
+	pi->ki = ki;
+	pi->te = te;
+	pi->out_min = out_min;
+	pi->out_max = out_max;
+	pi_reset(pi, 0.0f);
+}
+
+/**
+ * @brief	Remise à zéro, ou préchargement pour une reprise sans à-coup
+ * @param	pi Régulateur
+ * @param	integ Valeur initiale du terme intégral
+ * @note	Hors ISR, à appeler quand la boucle est arrêtée
+ */
+void pi_reset(pi_t * pi, float integ) {
+	pi->integ = integ;
+	pi->out = integ;
+}
+
+/**
+ * @brief	Une itération du régulateur
+ * @param	pi Régulateur
+ * @param	err Erreur consigne - mesure
+ * @param	ff Anticipation ajoutée à la sortie (0 si inutilisée)
+ * @retval	Commande bornée
+ */
+float pi_update(pi_t * pi, float err, float ff) {
+	float out_min = pi->out_min;
+	float out_max = pi->out_max;
+	float integ = pi->integ + pi->ki * pi->te * err;
+	float out = ff + pi->kp * err + integ;
+
+	// Anti-windup : intégration conditionnelle, l'intégrale n'augmente pas
+	// quand la sortie est déjà en butée dans le sens de l'erreur
+	if (out > out_max) {
+		out = out_max;
+		if (err > 0.0f) integ = pi->integ;
+	}
+	else if (out < out_min) {
+		out = out_min;
+		if (err < 0.0f) integ = pi->integ;
+	}
+
+	// L'intégrale seule ne doit jamais dépasser la plage de sortie
+	if (integ > out_max) integ = out_max;
+	else if (integ < out_min) integ = out_min;
+
+	pi->integ = integ;
+	pi->out = out;
+
+	return out;
+}
+
+/* End of functions ----------------------------------------------------------*/
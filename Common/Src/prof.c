@@ -0,0 +1,72 @@
+/**
+ ******************************************************************************
+ * @file	prof.c
+ * @brief	Profilage par compteur de cycles : min, max, moyenne, histogramme
+ ******************************************************************************
+ */
+
+#include "prof.h"
+
+#include <string.h>
+
+/* Functions -----------------------------------------------------------------*/
+
+static void prof_clear(prof_site_t * site) {
+	site->n = 0;
+	site->min = UINT32_MAX;
+	site->max = 0;
+	site->sum = 0;
+	memset(site->hist, 0, sizeof(site->hist));
+}
+
+/**
+ * @brief	Initialisation d'un site, avant la première mesure
+ * @param	site Site
+ * @param	name Nom affiché (chaîne constante)
+ */
+void prof_init(prof_site_t * site, const char * name) {
+	site->name = name;
+	site->req_reset = 0;
+	prof_clear(site);
+}
+
+/**
+ * @brief	Une mesure (écrivain unique du site, ISR ou boucle principale)
+ * @param	site Site
+ * @param	cycles Durée
+ */
+void prof_add(prof_site_t * site, uint32_t cycles) {
+	if (site->req_reset) {
+		prof_clear(site);
+		site->req_reset = 0;
+	}
+
+	uint32_t bin = (cycles > 0) ? 31 - __builtin_clz(cycles) : 0;
+
+	if (bin >= PROF_HIST_BINS) bin = PROF_HIST_BINS - 1;
+	site->hist[bin]++;
+
+	if (cycles < site->min) site->min = cycles;
+	if (cycles > site->max) site->max = cycles;
+	site->sum += cycles;
+	site->n++;
+}
+
+/**
+ * @brief	Demande de remise à zéro, appliquée à la mesure suivante
+ * @param	site Site
+ */
+void prof_reset(prof_site_t * site) {
+	site->req_reset = 1;
+}
+
+/**
+ * @brief	Durée moyenne
+ * @param	site Site (copie cohérente de préférence)
+ * @retval	Cycles, 0 sans mesure
+ */
+uint32_t prof_mean(const prof_site_t * site) {
+	return (site->n > 0) ? (uint32_t)(site->sum / site->n) : 0;
+}
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,154 @@
+/**
+ ******************************************************************************
+ * @file	sched.c
+ * @brief	Exécutif coopératif à déclenchement temporel
+ ******************************************************************************
+ */
+
+#include "sched.h"
+
+#include <string.h>
+
+/* Macros --------------------------------------------------------------------*/
+// Barrière compilateur : date écrite avant le compteur de libération (mono-cœur)
+#define SCHED_BARRIER() __asm volatile ("" ::: "memory")
+/* End of macros -------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static void sched_reset_stats(sched_task_t * t) {
+	t->misses = 0;
+	t->runs = 0;
+	t->exec_last = 0;
+	t->exec_max = 0;
+	t->latency_min = UINT32_MAX;
+	t->latency_max = 0;
+	t->overruns = 0;
+	t->consecutive = 0;
+}
+
+/**
+ * @brief	Initialisation, aucune tâche
+ * @param	s Exécutif
+ * @param	clock Horloge libre 32 bits (cycles CPU sur la carte)
+ * @param	fallback Appelée à l'entrée en mode dégradé (NULL : aucune)
+ */
+void sched_init(sched_t * s, uint32_t (* clock)(void), void (* fallback)(uint8_t task)) {
+	memset(s, 0, sizeof(*s));
+	s->clock = clock;
+	s->fallback = fallback;
+}
+
+/**
+ * @brief	Enregistrement d'une tâche, avant le premier sched_tick()
+ * @param	s Exécutif
+ * @param	name Nom (chaîne constante)
+ * @param	func Corps de la tâche, exécuté jusqu'au bout
+ * @param	period Période (ticks)
+ * @param	offset Décalage de la première libération (ticks, < period)
+ * @param	budget Durée d'exécution allouée (unités d'horloge)
+ * @param	flags SCHED_ESSENTIAL ou 0
+ * @retval	Indice de la tâche, -1 si la table est pleine ou les paramètres invalides
+ */
+int sched_add(sched_t * s, const char * name, void (* func)(void), uint32_t period, uint32_t offset,
+		uint32_t budget, uint8_t flags) {
+	if (s->n >= SCHED_MAX_TASKS || period == 0 || offset >= period) return -1;
+
+	sched_task_t * t = &s->tasks[s->n];
+
+	memset(t, 0, sizeof(*t));
+	t->name = name;
+	t->func = func;
+	t->period = period;
+	t->offset = offset;
+	t->budget = budget;
+	t->flags = flags;
+	t->countdown = offset;
+	sched_reset_stats(t);
+
+	return s->n++;
+}
+
+/**
+ * @brief	Un tick du timer matériel (ISR)
+ */
+void sched_tick(sched_t * s) {
+	uint32_t now = s->clock();
+
+	for (uint8_t i = 0 ; i < s->n ; i++) {
+		sched_task_t * t = &s->tasks[i];
+
+		if (t->countdown > 0) {
+			t->countdown--;
+			continue;
+		}
+		t->countdown = t->period - 1;
+		if (s->degraded && !(t->flags & SCHED_ESSENTIAL)) continue;
+
+		// Libération précédente pas encore démarrée : échéance manquée
+		if (t->released != t->started) t->misses++;
+
+		t->release_time = now;
+		SCHED_BARRIER();
+		t->released++;
+	}
+
+	s->tick++;
+}
+
+/**
+ * @brief	Exécution des tâches libérées (boucle principale)
+ * @retval	Nombre de tâches exécutées, 0 si aucune n'était prête
+ */
+uint8_t sched_run(sched_t * s) {
+	uint8_t count = 0;
+
+	for (uint8_t i = 0 ; i < s->n ; i++) {
+		sched_task_t * t = &s->tasks[i];
+		uint32_t released = t->released;
+
+		if (released == t->started) continue;
+		SCHED_BARRIER();
+
+		uint32_t start = s->clock();
+		uint32_t latency = start - t->release_time;
+
+		// Libérations en retard regroupées : une seule exécution
+		t->started = released;
+		t->func();
+
+		uint32_t exec = s->clock() - start;
+
+		t->runs++;
+		t->exec_last = exec;
+		if (exec > t->exec_max) t->exec_max = exec;
+		if (latency < t->latency_min) t->latency_min = latency;
+		if (latency > t->latency_max) t->latency_max = latency;
+
+		if (exec > t->budget) {
+			t->overruns++;
+			if (++t->consecutive >= SCHED_OVERRUN_LIMIT && !s->degraded) {
+				s->degraded = 1;
+				if (s->fallback != NULL) s->fallback(i);
+			}
+		}
+		else {
+			t->consecutive = 0;
+		}
+		count++;
+	}
+
+	return count;
+}
+
+/**
+ * @brief	Sortie du mode dégradé et remise à zéro des statistiques
+ */
+void sched_clear(sched_t * s) {
+	for (uint8_t i = 0 ; i < s->n ; i++) {
+		sched_reset_stats(&s->tasks[i]);
+	}
+	s->degraded = 0;
+}
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,199 @@
+/**
+ ******************************************************************************
+ * @file	scope.c
+ * @brief	Oscilloscope en RAM : pré-déclenchement, déclenchement, vidage
+ ******************************************************************************
+ */
+
+#include "scope.h"
+
+#include <string.h>
+
+/* Macros --------------------------------------------------------------------*/
+#define FRAME_MAX_SIZE 128			// taille maximale d'une trame (octets)
+/* End of macros -------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static uint8_t put_u16(uint8_t * dst, uint16_t v) {
+	dst[0] = v;
+	dst[1] = v >> 8;
+	return 2;
+}
+
+static uint8_t scope_triggered(const scope_t * scope, int16_t v) {
+	int16_t level = scope->trig_level;
+
+	switch (scope->trig_mode) {
+	case SCOPE_TRIG_RISING: return scope->prev < level && v >= level;
+	case SCOPE_TRIG_FALLING: return scope->prev > level && v <= level;
+	case SCOPE_TRIG_ABOVE: return v >= level;
+	case SCOPE_TRIG_BELOW: return v <= level;
+	default: return 0;
+	}
+}
+
+/**
+ * @brief	Initialisation : toutes les voies, sans décimation, déclenchement
+ *			manuel au quart du tampon, scope arrêté
+ * @param	scope Scope
+ */
+void scope_init(scope_t * scope) {
+	memset(scope, 0, sizeof(*scope));
+	scope->mask = (1 << SCOPE_CHANNELS) - 1;
+	scope->decimation = 1;
+	scope->pre = SCOPE_BUFFER_SIZE / SCOPE_CHANNELS / 4;
+	scope->trig_mode = SCOPE_TRIG_MANUAL;
+}
+
+/**
+ * @brief	Armement avec la configuration courante (boucle principale)
+ * @param	scope Scope
+ * @retval	0, -1 si la configuration est invalide
+ * @note	pre est borné à la profondeur moins un échantillon
+ */
+int scope_arm(scope_t * scope) {
+	uint8_t n = 0;
+
+	scope->state = SCOPE_IDLE;
+
+	for (uint8_t c = 0 ; c < SCOPE_CHANNELS ; c++) {
+		if (scope->mask & (1 << c)) n++;
+	}
+	if (n == 0 || scope->decimation == 0 || scope->trig_ch >= SCOPE_CHANNELS) return -1;
+
+	scope->n = n;
+	scope->depth = SCOPE_BUFFER_SIZE / n;
+	if (scope->pre >= scope->depth) scope->pre = scope->depth - 1;
+	scope->count = 0;
+	scope->widx = 0;
+	scope->filled = 0;
+	scope->force = 0;
+	scope->prev = scope->trig_level;	// pas de front sur le premier échantillon
+	scope->dump_idx = 0;
+	scope->dump_header = 0;
+
+	scope->state = SCOPE_ARMED;
+
+	return 0;
+}
+
+/**
+ * @brief	Déclenchement manuel, pris en compte une fois le pré-déclenchement rempli
+ * @param	scope Scope
+ */
+void scope_force(scope_t * scope) {
+	scope->force = 1;
+}
+
+/**
+ * @brief	Arrêt de l'acquisition ou du vidage en cours
+ * @param	scope Scope
+ */
+void scope_stop(scope_t * scope) {
+	scope->state = SCOPE_IDLE;
+}
+
+/**
+ * @brief	Nouvel échantillon (ISR, écrivain unique du tampon)
+ * @param	scope Scope
+ * @param	values SCOPE_CHANNELS valeurs
+ */
+void scope_sample(scope_t * scope, const int16_t * values) {
+	uint8_t state = scope->state;
+
+	if (state != SCOPE_ARMED && state != SCOPE_TRIGGERED) return;
+	if (++scope->count < scope->decimation) return;
+	scope->count = 0;
+
+	int16_t * dst = &scope->buf[(uint32_t)scope->widx * scope->n];
+	uint8_t mask = scope->mask;
+
+	for (uint8_t c = 0 ; c < SCOPE_CHANNELS ; c++) {
+		if (mask & (1 << c)) *dst++ = values[c];
+	}
+	if (++scope->widx >= scope->depth) scope->widx = 0;
+
+	if (state == SCOPE_ARMED) {
+		int16_t v = values[scope->trig_ch];
+
+		// Condition testée seulement avec pre échantillons avant celui-ci
+		if (scope->filled < scope->pre) {
+			scope->filled++;
+		}
+		else if (scope->force || scope_triggered(scope, v)) {
+			scope->post = scope->depth - scope->pre - 1;
+			state = SCOPE_TRIGGERED;
+		}
+		scope->prev = v;
+	}
+	else {
+		scope->post--;
+	}
+
+	if (state == SCOPE_TRIGGERED && scope->post == 0) {
+		// Tampon plein : le prochain emplacement est le plus ancien
+		scope->start = scope->widx;
+		state = SCOPE_DONE;
+	}
+	scope->state = state;
+}
+
+/**
+ * @brief	Vidage en rafale d'une acquisition terminée (boucle principale)
+ * @param	scope Scope
+ * @param	send Fonction d'émission d'une trame
+ * @param	max_len Taille maximale d'une trame acceptée par send
+ * @retval	1 tant que le vidage est en cours, 0 sinon
+ * @note	Envoie tant que send accepte, reprend à l'appel suivant sinon.
+ *			Le scope revient à SCOPE_IDLE une fois le tampon envoyé.
+ */
+uint8_t scope_dump(scope_t * scope, scope_send_t send, uint16_t max_len) {
+	uint8_t frame[FRAME_MAX_SIZE];
+
+	if (scope->state != SCOPE_DONE) return 0;
+	if (max_len > FRAME_MAX_SIZE) max_len = FRAME_MAX_SIZE;
+
+	if (!scope->dump_header) {
+		uint16_t len = 0;
+
+		len += put_u16(&frame[len], SCOPE_HEADER_INDEX);
+		frame[len++] = scope->mask;
+		len += put_u16(&frame[len], scope->depth);
+		len += put_u16(&frame[len], scope->pre);
+		len += put_u16(&frame[len], scope->decimation);
+
+		if (send(frame, len) != 0) return 1;
+		scope->dump_header = 1;
+	}
+
+	uint16_t per_frame = (max_len - 2) / (2 * scope->n);
+
+	while (scope->dump_idx < scope->depth) {
+		uint16_t count = scope->depth - scope->dump_idx;
+		uint16_t idx = scope->start + scope->dump_idx;
+		uint16_t len = 0;
+
+		if (count > per_frame) count = per_frame;
+		if (idx >= scope->depth) idx -= scope->depth;
+
+		len += put_u16(&frame[len], scope->dump_idx);
+		for (uint16_t i = 0 ; i < count ; i++) {
+			const int16_t * src = &scope->buf[(uint32_t)idx * scope->n];
+
+			for (uint8_t k = 0 ; k < scope->n ; k++) {
+				len += put_u16(&frame[len], (uint16_t)src[k]);
+			}
+			if (++idx >= scope->depth) idx = 0;
+		}
+
+		if (send(frame, len) != 0) return 1;
+		scope->dump_idx += count;
+	}
+
+	scope->state = SCOPE_IDLE;
+
+	return 0;
+}
+
+/* End of functions ----------------------------------------------------------*/
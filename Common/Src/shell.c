@@ -0,0 +1,218 @@
+/**
+ ******************************************************************************
+ * @file	shell.c
+ * @author 	Arnaud CHOBERT
+ * @brief	Shell commun TP/TD, indépendant du transport
+ ******************************************************************************
+ */
+
+#include <string.h>
+
+#include "shell.h"
+#include "fmt.h"
+
+/* Types ---------------------------------------------------------------------*/
+/* End of types --------------------------------------------------------------*/
+
+/* Macros --------------------------------------------------------------------*/
+#define ARGC_MAX 8
+#define BUFFER_SIZE 40
+/* End of macros -------------------------------------------------------------*/
+
+/* Constants -----------------------------------------------------------------*/
+/* End of constants ----------------------------------------------------------*/
+
+/* Variables -----------------------------------------------------------------*/
+static const shell_io_t * shell_io = NULL;
+static const char * prompt = "";
+
+static uint8_t pos = 0;
+static char buf[BUFFER_SIZE];
+static char backspace[] = "\b \b";
+
+// Réception binaire (protocole) multiplexée : démarre sur un octet 0x00
+static int (* frame_handler)(uint8_t ch) = NULL;
+static uint8_t frame_mode = 0;
+
+// Table des commandes en flash, bornes fournies par le .ld
+extern const shell_func_t __shell_cmd_start[];
+extern const shell_func_t __shell_cmd_end[];
+#define shell_func_list __shell_cmd_start
+#define shell_func_list_size (__shell_cmd_end - __shell_cmd_start)
+
+/* End of variables ----------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+/**
+ * @brief	Affichage du menu d'aide sur le shell
+ * @param	argc
+ * @param	argv
+ * @retval	0
+ */
+static int sh_help(int argc, char ** argv) {
+	int i;
+	for(i = 0 ; i < shell_func_list_size ; i++) {
+		fmt_puts(shell_func_list[i].cmd);
+		fmt_puts(" : ");
+		fmt_puts(shell_func_list[i].description);
+		fmt_puts("\r\n");
+	}
+	return 0;
+}
+
+/**
+ * @brief	Initialisation du shell
+ * @param	io Transport (lecture/écriture)
+ * @param	p Invite affichée après chaque commande ("" : pas d'invite)
+ */
+void shell_init(const shell_io_t * io, const char * p) {
+	shell_io = io;
+	prompt = p;
+	pos = 0;
+
+	fmt_set_output(io->write);
+	fmt_puts("\r\n\r\n===== Shell =====\r\n");
+	fmt_puts(prompt);
+}
+
+/**
+ *	@brief	Traitement d'un caractère reçu
+ *	@param	ch Caractère à traiter
+ */
+static void shell_line_input(char ch) {
+
+	switch (ch) {
+
+	case '\r':
+		// Enter
+		fmt_puts("\r\n");
+		buf[pos] = 0;
+		if (pos > 0) {
+			shell_exec(buf);
+		}
+		pos = 0;
+		fmt_puts(prompt);
+		break;
+
+	case '\b':
+	case 0x7F:
+		// Delete (DEL pour la plupart des terminaux)
+		if (pos > 0) {
+			pos--;
+			shell_io->write(backspace, 3);
+		}
+		break;
+
+	default:
+		if (pos < BUFFER_SIZE - 1) {
+			shell_io->write(&ch, 1);
+			buf[pos++] = ch;
+		}
+	}
+}
+
+/**
+ *	@brief	Traitement des caractères en attente (boucle principale, hors ISR)
+ */
+void shell_process() {
+	char ch;
+	int r;
+
+	if (shell_io == NULL) return;
+
+	while ((r = shell_io->read(&ch)) != 0) {
+		if (r < 0) {
+			// Flux interrompu par le transport : la ligne en cours est perdue
+			pos = 0;
+			continue;
+		}
+
+		if (frame_handler != NULL && (frame_mode || ch == 0)) {
+			frame_mode = frame_handler(ch);
+		}
+		else {
+			shell_line_input(ch);
+		}
+	}
+}
+
+/**
+ *	@brief	Déclare le récepteur des trames binaires
+ *	@param	handler Appelé pour chaque octet à partir d'un 0x00, renvoie 1 tant
+ *			que la trame n'est pas terminée
+ */
+void shell_set_frame_handler(int (* handler)(uint8_t ch)) {
+	frame_handler = handler;
+}
+
+/**
+ *	@brief	Recherche dichotomique d'une commande dans la table triée
+ *	@param	cmd Nom de la commande (terminé par ' ' ou '\0')
+ *	@param	len Longueur du nom
+ *	@retval	Commande de ce nom, sinon seule commande commençant par cmd,
+ *			NULL si aucune ou plusieurs
+ *	@note	Les noms de même préfixe sont contigus dans la table et le nom
+ *			exact, plus court, les précède : une seule recherche suffit
+ */
+const shell_func_t * shell_find(const char * cmd, size_t len) {
+	int lo = 0;
+	int hi = shell_func_list_size;
+
+	if (len == 0) return NULL;
+
+	// Premier nom >= cmd sur len caractères
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (strncmp(shell_func_list[mid].cmd, cmd, len) < 0) lo = mid + 1;
+		else hi = mid;
+	}
+
+	if (lo == shell_func_list_size || strncmp(shell_func_list[lo].cmd, cmd, len) != 0) {
+		return NULL;
+	}
+	if (shell_func_list[lo].cmd[len] == '\0') {
+		return &shell_func_list[lo];
+	}
+	if (lo + 1 < shell_func_list_size && strncmp(shell_func_list[lo + 1].cmd, cmd, len) == 0) {
+		return NULL;	// préfixe ambigu
+	}
+
+	return &shell_func_list[lo];
+}
+
+/**
+ *	@brief	Execution d'une commande du shell
+ *	@param	cmd Ligne saisie, découpée sur place en arguments
+ *	@retval	Valeur renvoyée par la commande, -1 si elle n'existe pas
+ */
+int shell_exec(char * cmd) {
+	int argc;
+	char * argv[ARGC_MAX];
+	char *p;
+
+	// Recherche de la commande sur le header, sans copie
+	const shell_func_t * f = shell_find(cmd, strcspn(cmd, " "));
+
+	if (f != NULL) {
+		argc = 1;
+		argv[0] = cmd;
+
+		for(p = cmd ; *p != '\0' && argc < ARGC_MAX ; p++){
+			if(*p == ' ') {
+				*p = '\0';
+				argv[argc++] = p+1;
+			}
+		}
+
+		return f->func(argc, argv);
+	}
+	fmt_puts(cmd);
+	fmt_puts(": command not found\r\n");
+	return -1;
+}
+
+SHELL_CMD(help, sh_help, "help");
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,340 @@
+/**
+ ******************************************************************************
+ * @file	shell_uart.c
+ * @author 	Arnaud CHOBERT
+ * @brief	Transport uart du shell : émission et réception par DMA
+ ******************************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "shell_uart.h"
+#include "fmt.h"
+
+/* Types ---------------------------------------------------------------------*/
+/* End of types --------------------------------------------------------------*/
+
+/* Macros --------------------------------------------------------------------*/
+#define RX_BUFFER_SIZE 256	// puissance de 2
+#define TX_BUFFER_SIZE 1024	// puissance de 2
+
+// Section critique sur les files : BASEPRI au niveau des communications si le
+// projet définit sa carte des priorités (les ISR plus urgentes, boucles de
+// commande, ne sont pas retardées ; aucune d'elles n'écrit dans le shell),
+// masquage global sinon
+#ifdef IRQ_PRIO_COMM
+#define UART_LOCK(key) do { (key) = __get_BASEPRI(); __set_BASEPRI_MAX(IRQ_BASEPRI(IRQ_PRIO_COMM)); } while (0)
+#define UART_UNLOCK(key) __set_BASEPRI(key)
+#else
+#define UART_LOCK(key) do { (key) = __get_PRIMASK(); __disable_irq(); } while (0)
+#define UART_UNLOCK(key) __set_PRIMASK(key)
+#endif
+/* End of macros -------------------------------------------------------------*/
+
+/* Constants -----------------------------------------------------------------*/
+const shell_io_t shell_uart_io = { uart_write, uart_read };
+/* End of constants ----------------------------------------------------------*/
+
+/* Variables -----------------------------------------------------------------*/
+static UART_HandleTypeDef * shell_huart = NULL;
+
+// File de réception : remplie par le DMA circulaire, rx_head avancé par
+// l'événement idle/HT/TC, rx_tail avancé par la boucle principale
+static volatile uint8_t rx_buf[RX_BUFFER_SIZE];
+static volatile uint16_t rx_head = 0;
+static volatile uint16_t rx_tail = 0;
+static volatile uint8_t rx_resync = 0;
+static volatile uint32_t rx_overflow = 0;
+static volatile uint32_t rx_errors = 0;
+
+// File d'émission : remplie par printf/uart_write, vidée par le DMA
+static uint8_t tx_buf[TX_BUFFER_SIZE];
+static volatile uint16_t tx_head = 0;
+static volatile uint16_t tx_tail = 0;
+static volatile uint16_t tx_dma_len = 0;	// 0 : DMA au repos
+static uint8_t tx_policy = SHELL_TX_POLICY;
+static shell_tx_stats_t tx_stats = {0};
+
+/* End of variables ----------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+/**
+ * @brief	Lance le transfert DMA du plus grand bloc contigu en attente
+ * @note	Sans effet si un transfert est déjà en cours
+ */
+static void uart_tx_kick() {
+	uint32_t key;
+
+	UART_LOCK(key);
+
+	if (shell_huart != NULL && tx_dma_len == 0 && tx_head != tx_tail) {
+		uint16_t len = (tx_head > tx_tail) ? tx_head - tx_tail : TX_BUFFER_SIZE - tx_tail;
+
+		tx_dma_len = len;
+		if (HAL_UART_Transmit_DMA(shell_huart, &tx_buf[tx_tail], len) != HAL_OK) {
+			tx_dma_len = 0;
+		}
+	}
+
+	UART_UNLOCK(key);
+}
+
+/**
+ * @brief	Fin d'un transfert DMA : libère le bloc et relance le suivant
+ * @param	huart
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+	if (huart == shell_huart) {
+		tx_tail = (tx_tail + tx_dma_len) & (TX_BUFFER_SIZE - 1);
+		tx_stats.sent += tx_dma_len;
+		tx_dma_len = 0;
+		uart_tx_kick();
+	}
+}
+
+/**
+ * Fonction indispensable pour utiliser printf() sur la liaison uart
+ * @param ch Caractère à écrire sur la liaison uart
+ * @return Caractère écrit sur la liaison uart
+ */
+int __io_putchar(int ch) {
+	char b = ch;
+
+	uart_write(&b, 1);
+	return ch;
+}
+
+/**
+ * Remplace la version weak de syscalls.c : une ligne printf = un seul appel
+ * @param file
+ * @param ptr Données à écrire
+ * @param len Nombre d'octets
+ * @return Nombre d'octets placés dans la file d'émission
+ */
+int _write(int file, char *ptr, int len) {
+	return uart_write(ptr, len);
+}
+
+/**
+ * Écriture sur la liaison uart (non bloquante tant que la file n'est pas pleine,
+ * attente bornée à SHELL_TX_BLOCK_TIMEOUT_MS en SHELL_TX_BLOCK)
+ * @param s Chaîne de caractères à écrire sur la liaison uart
+ * @param size Longueur de la chaîne de caractère
+ * @return Nombre d'octets placés dans la file d'émission
+ */
+int uart_write(char *s, uint16_t size) {
+	uint16_t i = 0;
+
+	while (i < size) {
+		uint32_t key;
+
+		UART_LOCK(key);
+
+		uint16_t used = (tx_head - tx_tail) & (TX_BUFFER_SIZE - 1);
+		uint16_t space = TX_BUFFER_SIZE - 1 - used;
+
+		while (space > 0 && i < size) {
+			tx_buf[tx_head] = s[i++];
+			tx_head = (tx_head + 1) & (TX_BUFFER_SIZE - 1);
+			space--;
+			used++;
+		}
+		if (used > tx_stats.peak) tx_stats.peak = used;
+
+		UART_UNLOCK(key);
+		uart_tx_kick();
+
+		if (i < size) {
+			// File pleine : on n'attend jamais en ISR ni avec les IT masquées
+			if (tx_policy == SHELL_TX_DROP || __get_IPSR() != 0 || key != 0 || __get_PRIMASK() != 0) {
+				tx_stats.dropped += size - i;
+				break;
+			}
+
+			// Relance à chaque tour : un kick refusé par la HAL (uart occupée)
+			// laisserait sinon la file pleine sans DMA pour la vider
+			uint32_t start = HAL_GetTick();
+
+			while (((tx_head - tx_tail) & (TX_BUFFER_SIZE - 1)) == TX_BUFFER_SIZE - 1) {
+				uart_tx_kick();
+				if (HAL_GetTick() - start >= SHELL_TX_BLOCK_TIMEOUT_MS) break;
+			}
+			if (((tx_head - tx_tail) & (TX_BUFFER_SIZE - 1)) == TX_BUFFER_SIZE - 1) {
+				// Émission bloquée : perte comptée plutôt qu'un blocage définitif
+				UART_LOCK(key);
+				tx_stats.dropped += size - i;
+				tx_stats.timeouts++;
+				UART_UNLOCK(key);
+				break;
+			}
+		}
+	}
+
+	return i;
+}
+
+/**
+ * @brief	Place libre dans la file d'émission
+ * @retval	Octets acceptés sans attente ni perte par uart_write()
+ */
+uint16_t uart_tx_free() {
+	return TX_BUFFER_SIZE - 1 - ((tx_head - tx_tail) & (TX_BUFFER_SIZE - 1));
+}
+
+/**
+ * @brief	Choix du comportement quand la file d'émission est pleine
+ * @param	policy SHELL_TX_DROP ou SHELL_TX_BLOCK
+ */
+void uart_tx_set_policy(uint8_t policy) {
+	tx_policy = policy;
+}
+
+/**
+ * @brief	Copie cohérente des compteurs d'émission
+ * @param	stats Destination
+ */
+void uart_tx_get_stats(shell_tx_stats_t * stats) {
+	uint32_t key;
+
+	UART_LOCK(key);
+	*stats = tx_stats;
+	UART_UNLOCK(key);
+}
+
+/**
+ * @brief	Lecture d'un caractère reçu (boucle principale)
+ * @param	ch Destination
+ * @retval	1 : caractère lu, 0 : file vide, -1 : débordement ou réception
+ *			relancée, les caractères en cours ont été perdus
+ */
+int uart_read(char * ch) {
+	if (rx_resync) {
+		// Caractères perdus (débordement ou réception relancée) : rx_tail a
+		// été replacé sur rx_head par l'ISR, la ligne en cours est abandonnée
+		rx_resync = 0;
+		return -1;
+	}
+
+	if (rx_tail == rx_head) {
+		// Relance d'un envoi refusé par la HAL (uart occupée au moment du kick)
+		uart_tx_kick();
+		return 0;
+	}
+
+	uint32_t key;
+	uint16_t tail = rx_tail;
+
+	*ch = rx_buf[tail];
+
+	// L'ISR peut avoir replacé rx_tail entre-temps : ne pas l'écraser
+	UART_LOCK(key);
+	if (rx_resync) {
+		UART_UNLOCK(key);
+		rx_resync = 0;
+		return -1;
+	}
+	rx_tail = (tail + 1) & (RX_BUFFER_SIZE - 1);
+	UART_UNLOCK(key);
+	return 1;
+}
+
+/**
+ * @brief	Démarrage du transport sur une uart déjà initialisée (DMA compris)
+ * @param	huart Liaison du shell
+ */
+void uart_init(UART_HandleTypeDef * huart) {
+	shell_huart = huart;
+	HAL_UARTEx_ReceiveToIdle_DMA(shell_huart, (uint8_t *)rx_buf, RX_BUFFER_SIZE);
+}
+
+/**
+ *	@brief	Événement de réception DMA : ligne idle, demi-buffer ou fin de buffer (contexte ISR)
+ *	@param	huart Liaison ayant reçu (ignoré si ce n'est pas celle du shell)
+ *	@param	size Position d'écriture du DMA dans rx_buf (RX_BUFFER_SIZE en fin de tour)
+ *	@note	Seul l'index d'écriture est publié, le traitement est fait par
+ *			shell_process() dans la boucle principale
+ */
+void uart_rx_event(UART_HandleTypeDef * huart, uint16_t size) {
+	if (huart != shell_huart) return;
+
+	uint16_t head = size & (RX_BUFFER_SIZE - 1);
+	uint16_t received = (head - rx_head) & (RX_BUFFER_SIZE - 1);
+	uint16_t used = (rx_head - rx_tail) & (RX_BUFFER_SIZE - 1);
+
+	if (used + received >= RX_BUFFER_SIZE) {
+		// Le DMA circulaire a réécrit des caractères non lus : le contenu
+		// entre rx_tail et head n'est plus cohérent, lecture reprise à head
+		rx_overflow++;
+		rx_tail = head;
+		rx_resync = 1;
+	}
+	rx_head = head;
+
+#if SHELL_EXEC_IN_ISR
+	shell_process();
+#endif
+}
+
+/**
+ *	@brief	Erreur uart : relance de la réception si la HAL l'a arrêtée
+ *	@param	huart
+ */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+	if (huart == shell_huart) {
+		rx_errors++;
+
+		// Erreur bloquante (overrun, DMA) : la HAL a arrêté la réception
+		if (huart->RxState == HAL_UART_STATE_READY) {
+			rx_head = 0;
+			rx_tail = 0;
+			rx_resync = 1;
+			HAL_UARTEx_ReceiveToIdle_DMA(shell_huart, (uint8_t *)rx_buf, RX_BUFFER_SIZE);
+		}
+	}
+}
+
+/**
+ *	@brief	Nombre de caractères perdus car la file de réception était pleine
+ *	@retval	Compteur de débordements
+ */
+uint32_t uart_rx_overflow() {
+	return rx_overflow;
+}
+
+/**
+ *	@brief	Nombre d'erreurs de réception uart (bruit, trame, overrun)
+ *	@retval	Compteur d'erreurs
+ */
+uint32_t uart_rx_errors() {
+	return rx_errors;
+}
+
+/**
+ * @brief	Affichage des statistiques d'émission uart
+ * @param	argc
+ * @param	argv "drop" ou "block" pour changer de politique
+ * @retval	0
+ */
+static int sh_tx(int argc, char ** argv) {
+	shell_tx_stats_t stats;
+
+	uart_tx_get_stats(&stats);
+	printf("tx sent = %lu\r\n", (unsigned long)stats.sent);
+	printf("tx dropped = %lu\r\n", (unsigned long)stats.dropped);
+	printf("tx timeouts = %lu\r\n", (unsigned long)stats.timeouts);
+	printf("tx peak = %u / %u\r\n", stats.peak, TX_BUFFER_SIZE - 1);
+	printf("tx policy = %s\r\n", tx_policy == SHELL_TX_DROP ? "drop" : "block");
+
+	if (argc == 2) {
+		if (!strcmp(argv[1], "drop")) uart_tx_set_policy(SHELL_TX_DROP);
+		else if (!strcmp(argv[1], "block")) uart_tx_set_policy(SHELL_TX_BLOCK);
+	}
+
+	return 0;
+}
+
+SHELL_CMD(tx, sh_tx, "Statistiques tx uart (tx drop|block)");
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,249 @@
+/**
+ ******************************************************************************
+ * @file	sysid.c
+ * @brief	Identification d'un moteur à courant continu : excitation SBPA et
+ *			moindres carrés
+ ******************************************************************************
+ */
+
+#include "sysid.h"
+
+#include <string.h>
+#include <math.h>
+
+/* Macros --------------------------------------------------------------------*/
+#define PRBS_SEED 0x7ACE			// état initial non nul du LFSR
+#define LS_PIVOT_MIN 1e-12			// pivot relatif : régresseurs non excités
+/* End of macros -------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+/**
+ * @brief	Initialisation de la SBPA
+ * @param	prbs Générateur
+ * @param	hold Périodes par bit (au moins 1)
+ */
+void prbs_init(prbs_t * prbs, uint16_t hold) {
+	prbs->lfsr = PRBS_SEED;
+	prbs->hold = (hold > 0) ? hold : 1;
+	prbs->count = 0;
+	prbs->bit = 1;
+}
+
+/**
+ * @brief	Valeur de la SBPA pour la période suivante (ISR)
+ * @param	prbs Générateur
+ * @retval	+1 ou -1, période 32767 bits
+ */
+int8_t prbs_next(prbs_t * prbs) {
+	if (prbs->count == 0) {
+		// x^15 + x^14 + 1
+		uint16_t fb = (prbs->lfsr ^ (prbs->lfsr >> 1)) & 1;
+
+		prbs->lfsr = (prbs->lfsr >> 1) | (fb << 14);
+		prbs->bit = (prbs->lfsr & 1) ? 1 : -1;
+	}
+	if (++prbs->count >= prbs->hold) prbs->count = 0;
+
+	return prbs->bit;
+}
+
+/**
+ * @brief	Régression vide à p paramètres
+ */
+void ls_init(ls_t * ls, uint8_t p) {
+	memset(ls, 0, sizeof(*ls));
+	ls->p = (p <= SYSID_MAX_PARAMS) ? p : SYSID_MAX_PARAMS;
+}
+
+/**
+ * @brief	Ajout d'une équation y = x.theta
+ */
+void ls_add(ls_t * ls, const float * x, float y) {
+	for (uint8_t r = 0 ; r < ls->p ; r++) {
+		for (uint8_t c = 0 ; c < ls->p ; c++) {
+			ls->a[r][c] += (double)x[r] * x[c];
+		}
+		ls->b[r] += (double)x[r] * y;
+	}
+	ls->yy += (double)y * y;
+	ls->y += y;
+	ls->n++;
+}
+
+/**
+ * @brief	Solution des moindres carrés (Gauss, pivot partiel)
+ * @param	ls Régression
+ * @param	theta Paramètres estimés
+ * @param	r2 Coefficient de détermination
+ * @retval	0, -1 si le système est singulier (régresseur non excité)
+ */
+int ls_solve(const ls_t * ls, float * theta, float * r2) {
+	double a[SYSID_MAX_PARAMS][SYSID_MAX_PARAMS + 1];
+	double x[SYSID_MAX_PARAMS];
+	uint8_t p = ls->p;
+	double scale = 0.0;
+
+	if (ls->n <= p) return -1;
+
+	for (uint8_t r = 0 ; r < p ; r++) {
+		for (uint8_t c = 0 ; c < p ; c++) a[r][c] = ls->a[r][c];
+		a[r][p] = ls->b[r];
+		if (fabs(a[r][r]) > scale) scale = fabs(a[r][r]);
+	}
+
+	for (uint8_t c = 0 ; c < p ; c++) {
+		uint8_t piv = c;
+
+		for (uint8_t r = c + 1 ; r < p ; r++) {
+			if (fabs(a[r][c]) > fabs(a[piv][c])) piv = r;
+		}
+		if (fabs(a[piv][c]) <= LS_PIVOT_MIN * scale) return -1;
+
+		for (uint8_t k = 0 ; k <= p ; k++) {
+			double t = a[c][k];
+			a[c][k] = a[piv][k];
+			a[piv][k] = t;
+		}
+		for (uint8_t r = c + 1 ; r < p ; r++) {
+			double m = a[r][c] / a[c][c];
+			for (uint8_t k = c ; k <= p ; k++) a[r][k] -= m * a[c][k];
+		}
+	}
+
+	for (int8_t r = p - 1 ; r >= 0 ; r--) {
+		double s = a[r][p];
+		for (uint8_t c = r + 1 ; c < p ; c++) s -= a[r][c] * x[c];
+		x[r] = s / a[r][r];
+	}
+
+	// Résidu à l'optimum : y'y - theta'.X'y
+	double res = ls->yy;
+	double tot = ls->yy - ls->y * ls->y / ls->n;
+
+	for (uint8_t r = 0 ; r < p ; r++) {
+		theta[r] = x[r];
+		res -= x[r] * ls->b[r];
+	}
+	*r2 = (tot > 0.0) ? (float)(1.0 - res / tot) : 0.0f;
+
+	return 0;
+}
+
+/**
+ * @brief	Initialisation d'une identification
+ * @param	id Identification
+ * @param	te Période des échantillons (s)
+ * @param	vbus Tension du bus (V) : u = 1 correspond à +vbus
+ * @param	ticks_per_rev Pas codeur par tour
+ * @param	block Périodes par bloc de la régression mécanique
+ */
+void sysid_init(sysid_t * id, float te, float vbus, uint32_t ticks_per_rev, uint16_t block) {
+	memset(id, 0, sizeof(*id));
+	id->te = te;
+	id->vbus = vbus;
+	id->rad_per_tick = 2.0f * (float)M_PI / (float)ticks_per_rev;
+	id->block = (block > 0) ? block : 1;
+	ls_init(&id->elec, 3);
+	ls_init(&id->mech, 2);
+}
+
+/**
+ * @brief	Échantillon suivant
+ * @param	id Identification
+ * @param	u Commande normalisée lue à cet échantillon (appliquée au suivant)
+ * @param	i Courant mesuré (A)
+ * @param	ticks Pas codeur depuis l'échantillon précédent
+ */
+void sysid_add(sysid_t * id, float u, float i, int16_t ticks) {
+	const uint32_t mask = SYSID_W_WINDOW - 1;
+	uint32_t k = id->k;
+
+	id->w_sum += ticks - id->w_hist[k & mask];
+	id->w_hist[k & mask] = ticks;
+	id->u_hist[k & mask] = u;
+	id->i_hist[k & mask] = i;
+	id->k++;
+
+	// Régression électrique sur l'échantillon m, la fenêtre de vitesse
+	// (pas k-W+1..k) étant centrée sur m-1
+	if (k > SYSID_W_WINDOW) {
+		uint32_t m = k - SYSID_W_WINDOW / 2 + 1;
+		float w = (float)id->w_sum * id->rad_per_tick / (SYSID_W_WINDOW * id->te);
+		float x[3] = {
+				id->i_hist[(m - 1) & mask],
+				0.5f * (id->u_hist[(m - 2) & mask] + id->u_hist[(m - 1) & mask]),
+				w
+		};
+
+		ls_add(&id->elec, x, id->i_hist[m & mask]);
+	}
+
+	// Régression mécanique par blocs
+	id->blk_i += i;
+	id->blk_ticks += ticks;
+	if (++id->blk_count >= id->block) {
+		float i_mean = id->blk_i / id->block;
+		float w_mean = (float)id->blk_ticks * id->rad_per_tick / (id->block * id->te);
+
+		if (id->blk_n > 0) {
+			float x[2] = {id->blk_w_prev, id->blk_i_prev};
+
+			ls_add(&id->mech, x, w_mean);
+		}
+		id->blk_w_prev = w_mean;
+		id->blk_i_prev = i_mean;
+		id->blk_n++;
+		id->blk_count = 0;
+		id->blk_i = 0.0f;
+		id->blk_ticks = 0;
+	}
+}
+
+/**
+ * @brief	Paramètres physiques déduits des deux régressions
+ * @param	id Identification
+ * @param	res Résultat ; J et f restent nuls si le rotor n'a pas tourné
+ * @retval	0, -1 si la régression électrique n'a pas de solution physique
+ */
+int sysid_solve(const sysid_t * id, sysid_result_t * res) {
+	float th[3];
+	float r2;
+
+	memset(res, 0, sizeof(*res));
+
+	// a = exp(-R.te/L), b = Vbus.(1 - a)/R, c = -ke.(1 - a)/R
+	if (ls_solve(&id->elec, th, &r2) != 0) {
+		// Rotor immobile : colonne de vitesse nulle, modèle R-L seul
+		ls_t rl = id->elec;
+
+		rl.p = 2;
+		if (ls_solve(&rl, th, &r2) != 0) return -1;
+		th[2] = 0.0f;
+	}
+	if (th[0] <= 0.0f || th[0] >= 1.0f || th[1] <= 0.0f) return -1;
+
+	res->r = id->vbus * (1.0f - th[0]) / th[1];
+	res->l = -res->r * id->te / logf(th[0]);
+	res->ke = -th[2] * id->vbus / th[1];
+	res->r2_elec = r2;
+
+	// d = exp(-f.T/J), e = ke.(1 - d)/f, T durée d'un bloc
+	float t = id->block * id->te;
+
+	if (res->ke > 0.0f && ls_solve(&id->mech, th, &r2) == 0 && th[1] > 0.0f && th[0] > 0.0f) {
+		if (th[0] < 1.0f) {
+			res->f = res->ke * (1.0f - th[0]) / th[1];
+			res->j = -res->f * t / logf(th[0]);
+		}
+		else {
+			// Frottement non observable sur la durée de l'essai
+			res->j = res->ke * t / th[1];
+		}
+		res->r2_mech = r2;
+	}
+
+	return 0;
+}
+
+/* End of functions ----------------------------------------------------------*/
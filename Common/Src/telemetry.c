@@ -0,0 +1,160 @@
+/**
+ ******************************************************************************
+ * @file	telemetry.c
+ * @brief	Télémétrie : file d'enregistrements sans verrou et trames binaires
+ ******************************************************************************
+ */
+
+#include "telemetry.h"
+
+#include <string.h>
+
+/* Macros --------------------------------------------------------------------*/
+#define RING_MASK (TELEM_RING_SIZE - 1)
+#define FRAME_MAX_SIZE 128			// taille maximale d'une trame (octets)
+
+// Barrière compilateur : ordre des écritures enregistrement / publication (mono-cœur)
+#define TELEM_BARRIER() __asm volatile ("" ::: "memory")
+/* End of macros -------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static uint8_t put_u32(uint8_t * dst, uint32_t v) {
+	dst[0] = v;
+	dst[1] = v >> 8;
+	dst[2] = v >> 16;
+	dst[3] = v >> 24;
+	return 4;
+}
+
+/**
+ * @brief	Initialisation, télémétrie arrêtée
+ * @param	telem Télémétrie
+ */
+void telem_init(telem_t * telem) {
+	memset(telem, 0, sizeof(*telem));
+	telem->mask = (1 << TELEM_CHANNELS) - 1;
+}
+
+/**
+ * @brief	Voies émises et décimation (boucle principale)
+ * @param	telem Télémétrie
+ * @param	mask Voies émises (bit i : voie i)
+ * @param	decimation 1 enregistrement tous les n appels de telem_begin(), 0 : arrêt
+ * @note	La file est vidée : les trames suivantes ont toutes le nouveau format
+ */
+void telem_config(telem_t * telem, uint8_t mask, uint16_t decimation) {
+	telem->decimation = 0;
+	telem->mask = mask & ((1 << TELEM_CHANNELS) - 1);
+	telem->tail = telem->head;
+	telem->decimation = decimation;
+}
+
+/**
+ * @brief	Réservation d'un enregistrement (producteur unique, ISR)
+ * @param	telem Télémétrie
+ * @retval	Enregistrement à remplir puis publier par telem_commit(), NULL si
+ *			l'appel est sauté par la décimation ou si la file est pleine
+ */
+telem_record_t * telem_begin(telem_t * telem) {
+	uint16_t decimation = telem->decimation;
+
+	if (decimation == 0 || ++telem->count < decimation) return NULL;
+	telem->count = 0;
+
+	uint16_t head = telem->head;
+	uint16_t used = (uint16_t)(head - telem->tail);
+
+	if (used >= TELEM_RING_SIZE) {
+		telem->dropped++;
+		return NULL;
+	}
+	if (used + 1 > telem->peak) telem->peak = used + 1;
+
+	return &telem->ring[head & RING_MASK];
+}
+
+/**
+ * @brief	Publication de l'enregistrement réservé par telem_begin()
+ * @param	telem Télémétrie
+ */
+void telem_commit(telem_t * telem) {
+	TELEM_BARRIER();
+	telem->head++;
+	telem->produced++;
+}
+
+/**
+ * @brief	Émission des enregistrements en attente (boucle principale)
+ * @param	telem Télémétrie
+ * @param	send Fonction d'émission d'une trame
+ * @param	max_len Taille maximale d'une trame acceptée par send
+ * @retval	Nombre d'enregistrements émis
+ * @note	S'arrête à la première trame refusée, qui sera reprise à l'appel
+ *			suivant : aucun enregistrement n'est perdu côté émission
+ */
+uint16_t telem_process(telem_t * telem, telem_send_t send, uint16_t max_len) {
+	uint8_t frame[FRAME_MAX_SIZE];
+	uint8_t mask = telem->mask;
+	uint16_t record_size = 4;
+	uint16_t total = 0;
+
+	for (uint8_t c = 0 ; c < TELEM_CHANNELS ; c++) {
+		if (mask & (1 << c)) record_size += 4;
+	}
+	if (max_len > FRAME_MAX_SIZE) max_len = FRAME_MAX_SIZE;
+	if (max_len < 2 + record_size) return 0;
+
+	uint16_t per_frame = (max_len - 2) / record_size;
+	uint16_t tail = telem->tail;
+	uint16_t head = telem->head;
+
+	TELEM_BARRIER();
+
+	while (tail != head) {
+		uint16_t n = (uint16_t)(head - tail);
+		uint16_t len = 2;
+
+		if (n > per_frame) n = per_frame;
+
+		frame[0] = mask;
+		frame[1] = n;
+		for (uint16_t i = 0 ; i < n ; i++) {
+			const telem_record_t * r = &telem->ring[(uint16_t)(tail + i) & RING_MASK];
+
+			len += put_u32(&frame[len], r->t);
+			for (uint8_t c = 0 ; c < TELEM_CHANNELS ; c++) {
+				if (mask & (1 << c)) len += put_u32(&frame[len], (uint32_t)r->ch[c]);
+			}
+		}
+
+		if (send(frame, len) != 0) {
+			telem->busy++;
+			break;
+		}
+
+		tail += n;
+		telem->tail = tail;
+		telem->sent += n;
+		telem->frames++;
+		total += n;
+	}
+
+	return total;
+}
+
+/**
+ * @brief	Copie des compteurs (lecture champ par champ, sans masquer les IT)
+ * @param	telem Télémétrie
+ * @param	stats Destination
+ */
+void telem_get_stats(const telem_t * telem, telem_stats_t * stats) {
+	stats->produced = telem->produced;
+	stats->dropped = telem->dropped;
+	stats->sent = telem->sent;
+	stats->frames = telem->frames;
+	stats->busy = telem->busy;
+	stats->peak = telem->peak;
+}
+
+/* End of functions ----------------------------------------------------------*/
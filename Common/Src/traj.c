@@ -0,0 +1,272 @@
+/**
+ ******************************************************************************
+ * @file	traj.c
+ * @brief	Générateur de trajectoire trapèze / S-curve en virgule fixe
+ ******************************************************************************
+ */
+
+#include "traj.h"
+
+#include <string.h>
+#include <math.h>
+
+/* Macros --------------------------------------------------------------------*/
+#define QUEUE_MASK (TRAJ_QUEUE_SIZE - 1)
+/* End of macros -------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+/**
+ * @brief	Durées entières d'une variation de vitesse dv > 0 (pas/tick)
+ * @param	nj Ticks de chaque phase à jerk constant
+ * @param	na Ticks à accélération constante
+ * @note	Durées arrondies par excès : le jerk et l'accélération effectifs,
+ *			dv/(nj.(nj+na)) et dv/(nj+na), restent sous les limites
+ */
+static void ramp_plan(float dv, float a, float j, uint32_t * nj, uint32_t * na) {
+	float tj;
+	float ta;
+
+	if (j <= 0.0f) {
+		// Trapèze : accélération en un tick
+		tj = 1.0f;
+		ta = dv / a - 1.0f;
+	}
+	else {
+		tj = a / j;
+		if (dv < a * tj) {
+			// L'accélération maximale n'est pas atteinte
+			tj = sqrtf(dv / j);
+			ta = 0.0f;
+		}
+		else {
+			ta = dv / a - tj;
+		}
+	}
+
+	*nj = (tj > 1.0f) ? (uint32_t)ceilf(tj) : 1;
+	*na = (ta > 0.0f) ? (uint32_t)ceilf(ta) : 0;
+}
+
+/**
+ * @brief	Vitesse de croisière d'un mouvement point à point de d pas
+ */
+static float peak_velocity(float d, float v, float a, float j) {
+	float t_acc;
+
+	if (j <= 0.0f) t_acc = v / a;
+	else if (v < a * a / j) t_acc = 2.0f * sqrtf(v / j);
+	else t_acc = v / a + a / j;
+
+	// Distance d'accélération + décélération = v.t_acc
+	if (v * t_acc <= d) return v;
+
+	if (j <= 0.0f) return sqrtf(d * a);
+
+	v = cbrtf(d * d * j / 4.0f);
+	if (v >= a * a / j) {
+		float b = a / j;
+		v = 0.5f * a * (-b + sqrtf(b * b + 4.0f * d / a));
+	}
+
+	return v;
+}
+
+static void add_phase(traj_move_t * m, int64_t jerk, uint32_t ticks) {
+	if (ticks > 0) {
+		m->phase[m->n].jerk = jerk;
+		m->phase[m->n].ticks = ticks;
+		m->n++;
+	}
+}
+
+/**
+ * @brief	Initialisation, file vide (hors ISR, générateur arrêté)
+ * @param	t Générateur
+ * @param	pos Position initiale (Q32.32 pas)
+ * @param	vel Vitesse initiale (Q32.32 pas/tick)
+ */
+void traj_init(traj_t * t, int64_t pos, int64_t vel) {
+	float vmax = t->vmax;
+	float amax = t->amax;
+	float jmax = t->jmax;
+
+	memset(t, 0, sizeof(*t));
+	t->vmax = vmax;
+	t->amax = amax;
+	t->jmax = jmax;
+	t->pos = pos;
+	t->vel = vel;
+	t->plan_pos = pos;
+	t->plan_vel = vel;
+	t->plan_pos_valid = (vel == 0);
+}
+
+/**
+ * @brief	Limites utilisées pour les mouvements planifiés ensuite
+ * @param	vmax Vitesse (pas/tick)
+ * @param	amax Accélération (pas/tick²)
+ * @param	jmax Jerk (pas/tick³), 0 : trapèze
+ */
+void traj_set_limits(traj_t * t, float vmax, float amax, float jmax) {
+	t->vmax = vmax;
+	t->amax = amax;
+	t->jmax = jmax;
+}
+
+/**
+ * @brief	Mise en file d'un mouvement point à point, arrêt sur la cible
+ * @param	t Générateur
+ * @param	target Position absolue (Q32.32 pas)
+ * @retval	0, -1 si la file est pleine, les limites invalides, ou si le
+ *			mouvement précédent ne s'arrête pas (mouvement en vitesse)
+ */
+int traj_move_pos(traj_t * t, int64_t target) {
+	if ((uint8_t)(t->head - t->tail) >= TRAJ_QUEUE_SIZE) return -1;
+	if (t->vmax <= 0.0f || t->amax <= 0.0f) return -1;
+
+	if (!t->plan_pos_valid) {
+		// Après un mouvement en vitesse : position connue seulement à l'arrêt
+		if (!traj_idle(t) || t->vel != 0) return -1;
+		t->plan_pos = t->pos;
+		t->plan_vel = 0;
+		t->plan_pos_valid = 1;
+	}
+	if (t->plan_vel != 0) return -1;
+
+	traj_move_t * m = &t->queue[t->head & QUEUE_MASK];
+	int64_t d = target - t->plan_pos;
+	int64_t ad = (d < 0) ? -d : d;
+
+	m->n = 0;
+	if (ad > 0) {
+		float df = (float)ad / (float)TRAJ_ONE;
+		float v = peak_velocity(df, t->vmax, t->amax, t->jmax);
+		uint32_t nj;
+		uint32_t na;
+		uint32_t nc;
+
+		ramp_plan(v, t->amax, t->jmax, &nj, &na);
+
+		uint32_t nacc = 2 * nj + na;
+		float tc = df / v - (float)nacc;
+		nc = (tc > 0.0f) ? (uint32_t)ceilf(tc) : 0;
+
+		// Vitesse de croisière exacte pour ces durées, puis jerk associé
+		int64_t vq = ad / (nacc + nc);
+		int64_t jq = vq / ((int64_t)nj * (nj + na));
+
+		if (d < 0) jq = -jq;
+
+		add_phase(m, jq, nj);
+		add_phase(m, 0, na);
+		add_phase(m, -jq, nj);
+		add_phase(m, 0, nc);
+		add_phase(m, -jq, nj);
+		add_phase(m, 0, na);
+		add_phase(m, jq, nj);
+	}
+	m->end_pos = target;
+	m->end_vel = 0;
+	m->end_pos_valid = 1;
+
+	t->plan_pos = target;
+	t->plan_vel = 0;
+	t->head++;
+
+	return 0;
+}
+
+/**
+ * @brief	Mise en file d'un changement de vitesse, maintenue ensuite
+ * @param	t Générateur
+ * @param	target Vitesse (Q32.32 pas/tick), bornée à vmax
+ * @retval	0, -1 si la file est pleine ou les limites invalides
+ */
+int traj_move_vel(traj_t * t, int64_t target) {
+	if ((uint8_t)(t->head - t->tail) >= TRAJ_QUEUE_SIZE) return -1;
+	if (t->vmax <= 0.0f || t->amax <= 0.0f) return -1;
+
+	int64_t vmax = (int64_t)(t->vmax * (float)TRAJ_ONE);
+	if (target > vmax) target = vmax;
+	else if (target < -vmax) target = -vmax;
+
+	traj_move_t * m = &t->queue[t->head & QUEUE_MASK];
+	int64_t dv = target - t->plan_vel;
+	int64_t adv = (dv < 0) ? -dv : dv;
+
+	m->n = 0;
+	if (adv > 0) {
+		uint32_t nj;
+		uint32_t na;
+
+		ramp_plan((float)adv / (float)TRAJ_ONE, t->amax, t->jmax, &nj, &na);
+
+		int64_t jq = adv / ((int64_t)nj * (nj + na));
+		if (dv < 0) jq = -jq;
+
+		add_phase(m, jq, nj);
+		add_phase(m, 0, na);
+		add_phase(m, -jq, nj);
+	}
+	m->end_pos = 0;
+	m->end_vel = target;
+	m->end_pos_valid = 0;
+
+	t->plan_vel = target;
+	t->plan_pos_valid = 0;
+	t->head++;
+
+	return 0;
+}
+
+/**
+ * @brief	Un tick du générateur (ISR, écrivain unique de l'état courant)
+ * @param	t Générateur
+ * @note	Sans mouvement en cours, la vitesse courante est maintenue
+ */
+void traj_tick(traj_t * t) {
+	const traj_move_t * m = &t->queue[t->tail & QUEUE_MASK];
+	int64_t v0 = t->vel;
+
+	if (!t->busy && t->tail != t->head) {
+		t->busy = 1;
+		t->phase = 0;
+		t->left = (m->n > 0) ? m->phase[0].ticks : 0;
+	}
+
+	if (t->busy && t->phase < m->n) {
+		t->acc += m->phase[t->phase].jerk;
+	}
+	t->vel += t->acc;
+	// Trapèzes : décélération miroir de l'accélération. Addition non signée :
+	// en vitesse, la position tourne modulo 2^32 pas sans comportement indéfini
+	t->pos = (int64_t)((uint64_t)t->pos + (uint64_t)((v0 + t->vel) / 2));
+
+	if (t->busy) {
+		if (t->left > 0) t->left--;
+
+		if (t->left == 0) {
+			if (++t->phase < m->n) {
+				t->left = m->phase[t->phase].ticks;
+			}
+			else {
+				// Fin du mouvement : recalage des arrondis
+				t->acc = 0;
+				t->vel = m->end_vel;
+				if (m->end_pos_valid) t->pos = m->end_pos;
+				t->busy = 0;
+				t->tail++;
+			}
+		}
+	}
+}
+
+/**
+ * @brief	Aucun mouvement en cours ni en attente
+ */
+uint8_t traj_idle(const traj_t * t) {
+	return !t->busy && t->tail == t->head;
+}
+
+/* End of functions ----------------------------------------------------------*/
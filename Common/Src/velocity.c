@@ -0,0 +1,103 @@
+/**
+ ******************************************************************************
+ * @file	velocity.c
+ * @brief	Estimation de vitesse par méthode M/T (pas codeur et date des fronts)
+ ******************************************************************************
+ */
+
+#include "velocity.h"
+
+#include <string.h>
+#include <math.h>
+
+/* Functions -----------------------------------------------------------------*/
+
+/**
+ * @brief	Initialisation, sans filtre
+ * @param	vel Estimateur
+ * @param	ticks_per_rev Pas codeur par tour
+ * @param	edge_ticks Pas codeur entre deux fronts capturés (4 en x4 sur TI1)
+ * @param	clk_hz Fréquence de l'horloge de datation
+ * @param	timeout_s Durée sans front au-delà de laquelle la vitesse est nulle
+ *			(inférieure à la période de débordement de l'horloge)
+ */
+void vel_init(vel_t * vel, uint32_t ticks_per_rev, uint32_t edge_ticks, uint32_t clk_hz, float timeout_s) {
+	memset(vel, 0, sizeof(*vel));
+	vel->rad_per_tick_s = 2.0f * (float)M_PI * (float)clk_hz / (float)ticks_per_rev;
+	vel->edge_ticks = edge_ticks;
+	vel->timeout = (uint32_t)(timeout_s * (float)clk_hz);
+	vel->alpha = 1.0f;
+}
+
+/**
+ * @brief	Passe-bas du premier ordre sur la sortie
+ * @param	vel Estimateur
+ * @param	cutoff_hz Fréquence de coupure, 0 : pas de filtre
+ * @param	sample_hz Fréquence d'appel de vel_update()
+ */
+void vel_set_filter(vel_t * vel, float cutoff_hz, float sample_hz) {
+	if (cutoff_hz <= 0.0f || cutoff_hz >= sample_hz) {
+		vel->alpha = 1.0f;
+	}
+	else {
+		vel->alpha = 1.0f - expf(-2.0f * (float)M_PI * cutoff_hz / sample_hz);
+	}
+}
+
+/**
+ * @brief	Front codeur capturé (premier front après le tick, contexte ISR)
+ * @param	vel Estimateur
+ * @param	cnt Compteur codeur au front
+ * @param	t Date du front (horloge de datation)
+ */
+void vel_capture(vel_t * vel, uint32_t cnt, uint32_t t) {
+	vel->cap_cnt = cnt;
+	vel->cap_t = t;
+	vel->cap_ready = 1;
+}
+
+/**
+ * @brief	Mise à jour au tick d'échantillonnage
+ * @param	vel Estimateur
+ * @param	now Date courante (horloge de datation)
+ * @retval	Vitesse estimée (rad/s)
+ */
+float vel_update(vel_t * vel, uint32_t now) {
+	if (vel->cap_ready) {
+		uint32_t cnt = vel->cap_cnt;
+		uint32_t t = vel->cap_t;
+
+		vel->cap_ready = 0;
+
+		// Fenêtre M/T : pas et durée exacts entre deux fronts
+		if (vel->edge_valid && t != vel->edge_t) {
+			int32_t dn = (int32_t)(cnt - vel->edge_cnt);
+			vel->w_raw = (float)dn / (float)(t - vel->edge_t) * vel->rad_per_tick_s;
+		}
+		vel->edge_cnt = cnt;
+		vel->edge_t = t;
+		vel->edge_valid = 1;
+	}
+	else if (vel->edge_valid) {
+		uint32_t dt = now - vel->edge_t;
+
+		if (dt >= vel->timeout) {
+			// Arrêt : la prochaine fenêtre repartira du prochain front
+			vel->w_raw = 0.0f;
+			vel->edge_valid = 0;
+		}
+		else if (dt > 0) {
+			// Pas de front depuis dt : |w| ne peut dépasser un intervalle de front sur dt
+			float bound = (float)vel->edge_ticks / (float)dt * vel->rad_per_tick_s;
+
+			if (vel->w_raw > bound) vel->w_raw = bound;
+			else if (vel->w_raw < -bound) vel->w_raw = -bound;
+		}
+	}
+
+	vel->w += vel->alpha * (vel->w_raw - vel->w);
+
+	return vel->w;
+}
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,77 @@
+/**
+ ******************************************************************************
+ * @file	bench_cobs.c
+ * @brief	Banc hôte des trames : débit (trames/s) et surcoût en octets
+ ******************************************************************************
+ *
+ * Pour chaque taille de données : codage seul, décodage et vérification
+ * seuls, puis surcoût moyen (délimiteurs, type, seq, CRC et codes COBS) sur
+ * des données aléatoires, et au pire (aucun octet nul).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cobs.h"
+
+/* Macros --------------------------------------------------------------------*/
+#define BENCH_FRAMES 200000
+/* End of macros -------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static double now_s() {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench(uint16_t len) {
+	static uint8_t data[256 + 97];
+	static uint8_t frame[COBS_FRAME_MAX_SIZE(256)];
+	static uint8_t msg[COBS_FRAME_MAX_SIZE(256)];
+	uint64_t bytes = 0;
+	volatile int sink = 0;
+	double t;
+
+	for (uint16_t i = 0 ; i < sizeof(data) ; i++) data[i] = rand();
+
+	t = now_s();
+	for (int k = 0 ; k < BENCH_FRAMES ; k++) {
+		bytes += cobs_frame_encode(0x06, k, &data[k % 97], len, frame);
+	}
+	double t_enc = now_s() - t;
+
+	uint16_t n = cobs_frame_encode(0x06, 1, data, len, frame);
+	t = now_s();
+	for (int k = 0 ; k < BENCH_FRAMES ; k++) {
+		sink += cobs_frame_decode(&frame[1], n - 2, msg);
+	}
+	double t_dec = now_s() - t;
+
+	memset(data, 0xA5, len);
+	uint16_t worst = cobs_frame_encode(0x06, 1, data, len, frame);
+
+	printf("%4u octets : codage %9.0f trames/s, decodage %9.0f trames/s, "
+			"surcout moyen %5.2f octets, au pire %u (borne %u)\n",
+			len, BENCH_FRAMES / t_enc, BENCH_FRAMES / t_dec,
+			(double)bytes / BENCH_FRAMES - len, worst - len,
+			COBS_FRAME_MAX_SIZE(len) - len);
+	(void)sink;
+}
+
+int main() {
+	static const uint16_t sizes[] = {0, 8, 32, 64, 128, 256};
+
+	srand(1);
+	for (unsigned i = 0 ; i < sizeof(sizes) / sizeof(sizes[0]) ; i++) {
+		bench(sizes[i]);
+	}
+
+	return 0;
+}
+
+/* End of functions ----------------------------------------------------------*/
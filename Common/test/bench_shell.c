@@ -0,0 +1,134 @@
+/**
+ ******************************************************************************
+ * @file	bench_shell.c
+ * @brief	Banc hôte du shell : recherche dichotomique dans la table en flash
+ *			contre l'ancienne recherche linéaire par strcmp
+ ******************************************************************************
+ *
+ * BENCH_CMDS commandes (16, 64 ou 256, une cible par taille) déclarées par
+ * SHELL_CMD, plus help. La référence reproduit l'ancien shell_exec() de
+ * myShell.c : copie du header dans un tampon sur la pile, puis parcours de
+ * la table remplie par shell_add(). Chaque ligne "cXX 12" est recherchée,
+ * plus une commande inconnue ; le temps moyen par recherche est affiché.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "shell.h"
+
+/* Macros --------------------------------------------------------------------*/
+#ifndef BENCH_CMDS
+#define BENCH_CMDS 16
+#endif
+
+#define BENCH_ROUNDS 20000
+#define SHELL_CMD_MAX_SIZE 16
+
+// Commandes c00 à cff, par blocs de 16 (préfixe hexadécimal h)
+#define BENCH_CMD(x) SHELL_CMD(c##x, bench_cmd, "");
+#define BENCH_CMD16(h) \
+	BENCH_CMD(h##0) BENCH_CMD(h##1) BENCH_CMD(h##2) BENCH_CMD(h##3) \
+	BENCH_CMD(h##4) BENCH_CMD(h##5) BENCH_CMD(h##6) BENCH_CMD(h##7) \
+	BENCH_CMD(h##8) BENCH_CMD(h##9) BENCH_CMD(h##a) BENCH_CMD(h##b) \
+	BENCH_CMD(h##c) BENCH_CMD(h##d) BENCH_CMD(h##e) BENCH_CMD(h##f)
+/* End of macros -------------------------------------------------------------*/
+
+/* Variables -----------------------------------------------------------------*/
+extern const shell_func_t __shell_cmd_start[];
+extern const shell_func_t __shell_cmd_end[];
+
+// Ancienne table en RAM, remplie au démarrage
+static shell_func_t linear_list[BENCH_CMDS + 1];
+static int linear_list_size = 0;
+/* End of variables ----------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static int bench_cmd(int argc, char ** argv) {
+	return 0;
+}
+
+BENCH_CMD16(0)
+#if BENCH_CMDS >= 64
+BENCH_CMD16(1) BENCH_CMD16(2) BENCH_CMD16(3)
+#endif
+#if BENCH_CMDS >= 256
+BENCH_CMD16(4) BENCH_CMD16(5) BENCH_CMD16(6) BENCH_CMD16(7)
+BENCH_CMD16(8) BENCH_CMD16(9) BENCH_CMD16(a) BENCH_CMD16(b)
+BENCH_CMD16(c) BENCH_CMD16(d) BENCH_CMD16(e) BENCH_CMD16(f)
+#endif
+
+static const shell_func_t * linear_find(const char * cmd) {
+	char header[SHELL_CMD_MAX_SIZE] = "";
+	int h = 0;
+
+	while (cmd[h] != ' ' && cmd[h] != '\0' && h < SHELL_CMD_MAX_SIZE - 1) {
+		header[h] = cmd[h];
+		h++;
+	}
+	header[h] = '\0';
+
+	for (int i = 0 ; i < linear_list_size ; i++) {
+		if (strcmp(linear_list[i].cmd, header) == 0) return &linear_list[i];
+	}
+
+	return NULL;
+}
+
+static double now_s() {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main() {
+	static char lines[BENCH_CMDS + 2][SHELL_CMD_MAX_SIZE];
+	int n = __shell_cmd_end - __shell_cmd_start;
+	int lines_n = 0;
+	int errors = 0;
+	volatile uintptr_t sink = 0;
+	double t;
+
+	// Même contenu, dans l'ordre des anciens appels à shell_add()
+	for (int i = 0 ; i < n ; i++) {
+		linear_list[linear_list_size++] = __shell_cmd_start[i];
+		snprintf(lines[lines_n++], SHELL_CMD_MAX_SIZE, "%s 12", __shell_cmd_start[i].cmd);
+	}
+	strcpy(lines[lines_n++], "zz 12");
+
+	// Les deux recherches doivent trouver la même commande
+	for (int i = 0 ; i < lines_n ; i++) {
+		const shell_func_t * a = shell_find(lines[i], strcspn(lines[i], " "));
+		const shell_func_t * b = linear_find(lines[i]);
+
+		if ((a == NULL) != (b == NULL) || (a != NULL && strcmp(a->cmd, b->cmd) != 0)) errors++;
+	}
+
+	t = now_s();
+	for (int r = 0 ; r < BENCH_ROUNDS ; r++) {
+		for (int i = 0 ; i < lines_n ; i++) {
+			sink += (uintptr_t)shell_find(lines[i], strcspn(lines[i], " "));
+		}
+	}
+	double t_find = (now_s() - t) / ((double)BENCH_ROUNDS * lines_n);
+
+	t = now_s();
+	for (int r = 0 ; r < BENCH_ROUNDS ; r++) {
+		for (int i = 0 ; i < lines_n ; i++) {
+			sink += (uintptr_t)linear_find(lines[i]);
+		}
+	}
+	double t_linear = (now_s() - t) / ((double)BENCH_ROUNDS * lines_n);
+
+	printf("%3d commandes : dichotomie %6.1f ns, lineaire strcmp %6.1f ns, gain x%.1f%s\n",
+			n, t_find * 1e9, t_linear * 1e9, t_linear / t_find,
+			errors ? " (RESULTATS DIFFERENTS)" : "");
+	(void)sink;
+
+	return n != BENCH_CMDS + 1 || errors != 0;
+}
+
+/* End of functions ----------------------------------------------------------*/
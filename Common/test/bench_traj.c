@@ -0,0 +1,86 @@
+/**
+ ******************************************************************************
+ * @file	bench_traj.c
+ * @brief	Banc hôte du générateur : coût de traj_tick() au pire et en moyenne
+ ******************************************************************************
+ *
+ * Chaque tick d'une série de mouvements S-curve et trapèze est mesuré
+ * individuellement (meilleur de BENCH_RUNS passages, pour écarter les
+ * interruptions de l'hôte). Compteur de cycles du processeur sur x86-64,
+ * horloge monotone en ns ailleurs. Le coût sur la cible est mesuré en
+ * place par DWT (commande traj du shell).
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "traj.h"
+
+/* Macros --------------------------------------------------------------------*/
+#define BENCH_RUNS 20
+#define BENCH_TICKS 40000
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CLOCK() __rdtsc()
+#define BENCH_UNIT "cycles"
+#else
+#define BENCH_CLOCK() bench_ns()
+#define BENCH_UNIT "ns"
+#endif
+/* End of macros -------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static inline uint64_t bench_ns() {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void plan(traj_t * t) {
+	traj_init(t, 0, 0);
+	traj_set_limits(t, 50.0f, 0.5f, 0.01f);
+	traj_move_pos(t, 20000 * TRAJ_ONE);
+	traj_move_pos(t, -3000 * TRAJ_ONE);
+	traj_set_limits(t, 20.0f, 0.2f, 0.0f);
+	traj_move_pos(t, 5000 * TRAJ_ONE);
+	traj_set_limits(t, 30.0f, 0.3f, 0.005f);
+	traj_move_vel(t, 25 * TRAJ_ONE);
+	traj_move_vel(t, 0);
+}
+
+int main() {
+	static traj_t t;
+	static uint64_t best[BENCH_TICKS];
+	uint64_t worst = 0;
+	uint64_t sum = 0;
+	int n = 0;
+
+	memset(best, 0xFF, sizeof(best));
+	for (int r = 0 ; r < BENCH_RUNS ; r++) {
+		plan(&t);
+		for (int k = 0 ; k < BENCH_TICKS && !traj_idle(&t) ; k++) {
+			uint64_t t0 = BENCH_CLOCK();
+			traj_tick(&t);
+			uint64_t dt = BENCH_CLOCK() - t0;
+
+			if (dt < best[k]) best[k] = dt;
+			if (k >= n) n = k + 1;
+		}
+	}
+
+	for (int k = 0 ; k < n ; k++) {
+		if (best[k] > worst) worst = best[k];
+		sum += best[k];
+	}
+
+	printf("traj_tick : %d ticks, pire %llu %s, moyenne %.1f %s (mesure comprise)\n",
+			n, (unsigned long long)worst, BENCH_UNIT, (double)sum / n, BENCH_UNIT);
+
+	return n == 0;
+}
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,170 @@
+/**
+ ******************************************************************************
+ * @file	bench_velocity.c
+ * @brief	Banc hôte de la vitesse : erreur efficace M/T contre méthode M
+ ******************************************************************************
+ *
+ * Les deux estimateurs lisent le même codeur simulé (position continue,
+ * phase initiale tirée au hasard) :
+ *  - M : pas comptés entre deux ticks, w = dN.2.pi.fe / N (calcul de "v" et
+ *    de la boucle de vitesse avant velocity.c) ;
+ *  - M/T : vel_capture() sur le premier front TI1 après chaque tick, daté
+ *    avec un retard tiré dans [0, gigue], puis vel_update() au tick (w_raw,
+ *    sans passe-bas).
+ * Traces : vitesses constantes de l'arrêt presque complet à la pleine
+ * vitesse, et rampe 0 -> pleine vitesse (erreur comptée contre la vitesse
+ * vraie au tick, retard des fenêtres compris). Cadences : boucle de vitesse
+ * (1 kHz) et 50 Hz.
+ *
+ * Vérifié, tant que la capture est servie en priorité (gigue <= GOOD_JITTER) :
+ *  - vitesse constante : M/T a une erreur efficace plus faible que M à
+ *    toutes les vitesses et aux deux cadences (résolution) ;
+ *  - rampe : l'erreur de M/T est son seul retard, la fenêtre se fermant au
+ *    front qui suit le tick précédent (centre ~1,5 période en arrière, contre
+ *    0,5 pour M) : acc.1,5/fe. À 50 Hz ce retard domine et M est meilleure.
+ * Les lignes à JITTER_ISR cycles (capture retardée par une ISR complète) ne
+ * sont qu'affichées : à pleine vitesse la méthode M y redevient meilleure.
+ */
+
+#include <stdlib.h>
+
+#include "velocity.h"
+#include "test.h"
+
+/* Macros --------------------------------------------------------------------*/
+#define CLK 170000000.0			// DWT
+#define TPR 4000				// ENC_TICKS_PER_REV
+#define EDGE 4					// VEL_EDGE_TICKS
+#define TIMEOUT_S 0.1f			// VEL_TIMEOUT_S
+#define CLK0 0xFFF00000u		// débordement de l'horloge en cours de trace
+#define DURATION 2.0			// s par trace
+#define W_FULL 500.0			// rad/s
+#define GOOD_JITTER 100			// cycles, capture la plus prioritaire
+#define JITTER_ISR 5000			// cycles, une ISR ADC ou TIM6 complète
+/* End of macros -------------------------------------------------------------*/
+
+/* Types ---------------------------------------------------------------------*/
+// Position w0.t + acc.t²/2 (rad), phase p0 (pas)
+typedef struct{
+	const char * name;
+	double w0;
+	double acc;
+} trace_t;
+
+typedef struct{
+	double m;
+	double mt;
+} rms_t;
+/* End of types --------------------------------------------------------------*/
+
+/* Variables -----------------------------------------------------------------*/
+static const trace_t traces[] = {
+		{"0,5 rad/s", 0.5, 0.0},
+		{"5 rad/s", 5.0, 0.0},
+		{"50 rad/s", 50.0, 0.0},
+		{"500 rad/s", W_FULL, 0.0},
+		{"rampe 0-500", 0.0, W_FULL / DURATION},
+};
+static const double rates[] = {1000.0, 50.0};	// SPEED_LOOP_HZ, 50 Hz
+static const uint32_t jitters[] = {0, GOOD_JITTER, JITTER_ISR};
+/* End of variables ----------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static uint32_t clk(double t) {
+	return CLK0 + (uint32_t)(uint64_t)llround(t * CLK);
+}
+
+// Position en pas à t
+static double ticks_at(const trace_t * tr, double p0, double t) {
+	return p0 + (tr->w0 * t + 0.5 * tr->acc * t * t) * TPR / (2.0 * M_PI);
+}
+
+// Date du passage à la position p (pas), vitesse positive
+static double time_at(const trace_t * tr, double p0, double p) {
+	double theta = (p - p0) * 2.0 * M_PI / TPR;
+
+	if (tr->acc == 0.0) return theta / tr->w0;
+	return (sqrt(tr->w0 * tr->w0 + 2.0 * tr->acc * theta) - tr->w0) / tr->acc;
+}
+
+static rms_t run(const trace_t * tr, double fs, uint32_t jitter) {
+	vel_t vel;
+	double p0 = (double)rand() / RAND_MAX;
+	long cnt_prev = (long)floor(p0);
+	int edges = 0;
+	double sum_m = 0.0;
+	double sum_mt = 0.0;
+	int n = 0;
+
+	vel_init(&vel, TPR, EDGE, (uint32_t)CLK, TIMEOUT_S);
+
+	for (int k = 1 ; k <= (int)(DURATION * fs) ; k++) {
+		double t_tick = k / fs;
+		double p = ticks_at(tr, p0, t_tick);
+		long cnt = (long)floor(p);
+		double w = tr->w0 + tr->acc * t_tick;
+
+		// M : pas comptés sur la période
+		double w_m = (double)(cnt - cnt_prev) * 2.0 * M_PI * fs / TPR;
+		cnt_prev = cnt;
+
+		// M/T : fenêtre fermée par le front capturé après le tick précédent
+		double w_mt = vel_update(&vel, clk(t_tick));
+
+		// Une fois la première fenêtre M/T fermée, mêmes ticks pour les deux
+		if (edges >= 2) {
+			sum_m += (w_m - w) * (w_m - w);
+			sum_mt += (w_mt - w) * (w_mt - w);
+			n++;
+		}
+
+		// Premier front TI1 (multiple de EDGE) après le tick
+		long m = (long)floor(p / EDGE) + 1;
+		double t_edge = time_at(tr, p0, (double)(m * EDGE));
+
+		if (t_edge < (k + 1) / fs) {
+			uint32_t lat = jitter ? (uint32_t)rand() % (jitter + 1) : 0;
+
+			vel_capture(&vel, (uint32_t)(m * EDGE), clk(t_edge) + lat);
+			edges++;
+		}
+	}
+
+	rms_t r = {0.0, 0.0};
+
+	if (n > 0) {
+		r.m = sqrt(sum_m / n);
+		r.mt = sqrt(sum_mt / n);
+	}
+	return r;
+}
+
+int main() {
+	srand(1);
+
+	printf("%-8s %-12s %8s %12s %12s\n", "fe", "trace", "gigue", "M (rad/s)", "M/T (rad/s)");
+	for (size_t r = 0 ; r < sizeof(rates) / sizeof(rates[0]) ; r++) {
+		for (size_t i = 0 ; i < sizeof(traces) / sizeof(traces[0]) ; i++) {
+			for (size_t j = 0 ; j < sizeof(jitters) / sizeof(jitters[0]) ; j++) {
+				rms_t e = run(&traces[i], rates[r], jitters[j]);
+
+				printf("%-8.0f %-12s %8u %12.5f %12.5f\n",
+						rates[r], traces[i].name, jitters[j], e.m, e.mt);
+				if (jitters[j] > GOOD_JITTER) continue;
+				if (traces[i].acc == 0.0) {
+					CHECK(e.mt < e.m);
+				}
+				else {
+					double lag = 1.5 * traces[i].acc / rates[r];
+
+					CHECK_NEAR(e.mt, lag, 0.1 * lag);
+				}
+			}
+		}
+	}
+
+	return TEST_END();
+}
+
+/* End of functions ----------------------------------------------------------*/
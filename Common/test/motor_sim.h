@@ -0,0 +1,138 @@
+/**
+ ******************************************************************************
+ * @file	motor_sim.h
+ * @brief	Moteur à courant continu simulé pour les tests et outils hôte
+ ******************************************************************************
+ *
+ * Modèle : L.di/dt = Vbus.u - R.i - ke.w et J.dw/dt = ke.i - f.w, intégré en
+ * RK4 sur MOTOR_SIM_SUBSTEPS pas par période MLI (tension moyenne de la
+ * période). motor_sim_sample() puis motor_sim_write() reproduisent l'ISR de
+ * fin de séquence de la cible : mesure du courant et des pas codeur
+ * (quantifiés) au sommet du comptage centré, puis écriture de CCR1,
+ * préchargé : la commande ne s'applique qu'au passage par zéro suivant, une
+ * demi-période plus tard. motor_sim_step() enchaîne les deux (boucle
+ * ouverte).
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef MOTOR_SIM_H_
+#define MOTOR_SIM_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <math.h>
+
+/* Exported macros -----------------------------------------------------------*/
+// Paramètres de la cible (CONTROL.h, main.c du TP)
+#define MOTOR_SIM_ARR 1023
+#define MOTOR_SIM_TE (5.0 * 2 * (MOTOR_SIM_ARR + 1) / 170e6)	// MLI centrée, ~60 µs
+#define MOTOR_SIM_VBUS 24.0
+#define MOTOR_SIM_TICKS_PER_REV 4000
+#define MOTOR_SIM_A_PER_LSB (3.3 / 4096 / 0.05 / 16)	// CURRENT_A_PER_LSB / CURRENT_ADC_SCALE
+
+// Moteur simulé par défaut
+#define MOTOR_SIM_R 1.2				// Ohm
+#define MOTOR_SIM_L 1.5e-3			// H
+#define MOTOR_SIM_KE 0.05			// V.s/rad
+#define MOTOR_SIM_J 2e-5			// kg.m²
+#define MOTOR_SIM_F 2e-4			// N.m.s/rad
+
+#define MOTOR_SIM_SUBSTEPS 16
+/* End of exported macros ----------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct{
+	double r, l, ke, j, f;
+	uint8_t locked;				// rotor bloqué : w = 0
+
+	double i;					// A
+	double w;					// rad/s
+	double theta;				// rad
+	double u;					// commande de la période en cours
+	double u_next;				// CCR1 écrit, chargé au prochain passage par zéro
+	int64_t ticks;				// dernière position codeur lue
+} motor_sim_t;
+
+// Échantillon tel que rangé par le scope de la cible
+typedef struct{
+	int16_t adc;				// SCOPE_CH_ADC0 : courant, 1/16 de LSB ADC
+	int16_t duty;				// SCOPE_CH_DUTY : CCR1
+	int16_t delta;				// SCOPE_CH_DELTA : pas depuis l'échantillon précédent
+} motor_sim_sample_t;
+/* End of exported types -----------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static inline void motor_sim_init(motor_sim_t * m) {
+	*m = (motor_sim_t){
+		.r = MOTOR_SIM_R, .l = MOTOR_SIM_L, .ke = MOTOR_SIM_KE,
+		.j = MOTOR_SIM_J, .f = MOTOR_SIM_F
+	};
+}
+
+static inline void motor_sim_deriv(const motor_sim_t * m, double i, double w, double * di, double * dw) {
+	*di = (MOTOR_SIM_VBUS * m->u - m->r * i - m->ke * w) / m->l;
+	*dw = m->locked ? 0.0 : (m->ke * i - m->f * w) / m->j;
+}
+
+// Demi-période MLI à commande constante
+static inline void motor_sim_half(motor_sim_t * m) {
+	double h = MOTOR_SIM_TE / MOTOR_SIM_SUBSTEPS;
+
+	for (int n = 0 ; n < MOTOR_SIM_SUBSTEPS / 2 ; n++) {
+		double i1, w1, i2, w2, i3, w3, i4, w4;
+
+		motor_sim_deriv(m, m->i, m->w, &i1, &w1);
+		motor_sim_deriv(m, m->i + h / 2 * i1, m->w + h / 2 * w1, &i2, &w2);
+		motor_sim_deriv(m, m->i + h / 2 * i2, m->w + h / 2 * w2, &i3, &w3);
+		motor_sim_deriv(m, m->i + h * i3, m->w + h * w3, &i4, &w4);
+
+		m->theta += h / 6 * (m->w + 2 * (m->w + h / 2 * w1) + 2 * (m->w + h / 2 * w2) + (m->w + h * w3));
+		m->i += h / 6 * (i1 + 2 * i2 + 2 * i3 + i4);
+		m->w += h / 6 * (w1 + 2 * w2 + 2 * w3 + w4);
+	}
+}
+
+// Période suivante jusqu'à la fin de séquence ADC : mesures (duty : CCR1 en place)
+static inline motor_sim_sample_t motor_sim_sample(motor_sim_t * m) {
+	motor_sim_sample_t s;
+
+	motor_sim_half(m);
+	m->u = m->u_next;
+	motor_sim_half(m);
+
+	int64_t ticks = (int64_t)floor(m->theta * MOTOR_SIM_TICKS_PER_REV / (2 * M_PI));
+
+	s.adc = (int16_t)lround(m->i / MOTOR_SIM_A_PER_LSB);
+	s.duty = (int16_t)lround((m->u_next + 1.0) * 0.5 * (MOTOR_SIM_ARR + 1));
+	s.delta = (int16_t)(ticks - m->ticks);
+	m->ticks = ticks;
+
+	return s;
+}
+
+// Nouvelle commande u (CCR1 comme control_write_duty), chargée une
+// demi-période plus tard ; rend CCR1
+static inline int16_t motor_sim_write(motor_sim_t * m, double u) {
+	int32_t cmd = (int32_t)((u + 1.0) * 0.5 * (MOTOR_SIM_ARR + 1));
+
+	if (cmd < 0) cmd = 0;
+	else if (cmd > MOTOR_SIM_ARR) cmd = MOTOR_SIM_ARR;
+
+	m->u_next = 2.0 * cmd / (MOTOR_SIM_ARR + 1) - 1.0;
+
+	return (int16_t)cmd;
+}
+
+// Boucle ouverte : mesures puis commande u, comme l'ISR de la cible
+static inline motor_sim_sample_t motor_sim_step(motor_sim_t * m, double u) {
+	motor_sim_sample_t s = motor_sim_sample(m);
+
+	s.duty = motor_sim_write(m, u);
+
+	return s;
+}
+
+/* End of functions ----------------------------------------------------------*/
+
+#endif /* MOTOR_SIM_H_ */
@@ -0,0 +1,298 @@
+/**
+ ******************************************************************************
+ * @file	sysid_fit.c
+ * @brief	Outil hôte : identification sur une capture "id" exportée du TP
+ ******************************************************************************
+ *
+ *   sysid_fit [options] capture.bin
+ *
+ * capture.bin : octets reçus sur la liaison série pendant et après la
+ * commande "id" (ex : cat /dev/ttyACM0 > capture.bin), texte du shell
+ * compris. Les trames entre délimiteurs 0x00 sont décodées (cobs.h), les
+ * réponses du scope (PROTOCOL_SCOPE | PROTOCOL_REPLY) rassemblées suivant
+ * leur entête, puis chaque capture complète passe par sysid_add() et
+ * sysid_solve() comme sur la carte, sans budget de temps.
+ *
+ * Options (valeurs du TP par défaut) :
+ *   -a <arr>	ARR de TIM1 (conversion CCR1 -> u)
+ *   -t <te>	période MLI (s)
+ *   -v <vbus>	tension du bus (V)
+ *   -n <pas>	pas codeur par tour
+ *   -b <n>		périodes par bloc de la régression mécanique
+ *   -i <A>		courant par unité de la voie ADC0 (A)
+ *   -s		écrit dans capture.bin l'essai "id" sur le moteur simulé
+ *			(motor_sim.h) au lieu de l'ajuster
+ *   -x		code de retour non nul si l'ajustement s'écarte du moteur
+ *			simulé (chaîne complète vérifiée par ctest)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "cobs.h"
+#include "scope.h"
+#include "sysid.h"
+#include "motor_sim.h"
+
+/* Macros --------------------------------------------------------------------*/
+#define SCOPE_REPLY 0x87			// PROTOCOL_SCOPE | PROTOCOL_REPLY (TP)
+#define DATA_MAX_SIZE 64			// PROTOCOL_DATA_MAX_SIZE (TP)
+
+// Voies du scope (main.c du TP)
+#define CH_ADC0 0
+#define CH_DUTY 2
+#define CH_DELTA 3
+
+#define SIM_BIAS 0.3
+#define SIM_AMPLITUDE 0.1
+#define SIM_HOLD 4					// SYSID_HOLD
+#define CHECK_TOL 0.05				// écart relatif accepté par -x
+/* End of macros -------------------------------------------------------------*/
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct{
+	uint16_t arr;
+	float te;
+	float vbus;
+	uint32_t ticks_per_rev;
+	uint16_t block;
+	float a_per_unit;
+} fit_cfg_t;
+
+// Capture en cours de réassemblage
+typedef struct{
+	uint8_t mask;
+	uint8_t n;
+	uint16_t depth;
+	uint32_t received;			// échantillons reçus
+	int16_t buf[SCOPE_BUFFER_SIZE];
+} capture_t;
+/* End of types --------------------------------------------------------------*/
+
+/* Variables -----------------------------------------------------------------*/
+static FILE * sim_out;
+static uint8_t sim_seq = 0;
+/* End of variables ----------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static uint16_t get_u16(const uint8_t * p) {
+	return p[0] | (p[1] << 8);
+}
+
+// Position d'une voie dans un échantillon entrelacé (ordre croissant)
+static int channel_pos(uint8_t mask, uint8_t ch) {
+	int pos = 0;
+
+	if (!(mask & (1 << ch))) return -1;
+	for (uint8_t c = 0 ; c < ch ; c++) {
+		if (mask & (1 << c)) pos++;
+	}
+	return pos;
+}
+
+static int fit(const capture_t * cap, const fit_cfg_t * cfg, sysid_result_t * res) {
+	int adc = channel_pos(cap->mask, CH_ADC0);
+	int duty = channel_pos(cap->mask, CH_DUTY);
+	int delta = channel_pos(cap->mask, CH_DELTA);
+	sysid_t id;
+
+	if (adc < 0 || duty < 0 || delta < 0) {
+		fprintf(stderr, "capture sans les voies ADC0, DUTY et DELTA (masque 0x%02x)\n", cap->mask);
+		return -1;
+	}
+
+	sysid_init(&id, cfg->te, cfg->vbus, cfg->ticks_per_rev, cfg->block);
+	for (uint32_t k = 0 ; k < cap->depth ; k++) {
+		const int16_t * s = &cap->buf[k * cap->n];
+		float u = 2.0f * (float)s[duty] / (float)(cfg->arr + 1) - 1.0f;
+
+		sysid_add(&id, u, (float)s[adc] * cfg->a_per_unit, s[delta]);
+	}
+
+	if (sysid_solve(&id, res) != 0) {
+		fprintf(stderr, "pas de modele electrique valide\n");
+		return -1;
+	}
+	printf("%u echantillons\n", cap->depth);
+	printf("R = %.4f Ohm\nL = %.4f mH\nke = %.5f V.s/rad\n", res->r, res->l * 1e3, res->ke);
+	printf("J = %.3f g.cm2\nf = %.3f uN.m.s/rad\n", res->j * 1e7, res->f * 1e6);
+	printf("R2 elec = %.5f, R2 meca = %.5f\n", res->r2_elec, res->r2_mech);
+
+	return 0;
+}
+
+static int check(const sysid_result_t * res) {
+	const double expected[] = {MOTOR_SIM_R, MOTOR_SIM_L, MOTOR_SIM_KE, MOTOR_SIM_J, MOTOR_SIM_F};
+	const double fitted[] = {res->r, res->l, res->ke, res->j, res->f};
+	int failures = 0;
+
+	for (int p = 0 ; p < 5 ; p++) {
+		if (fabs(fitted[p] - expected[p]) > CHECK_TOL * expected[p]) {
+			fprintf(stderr, "parametre %d : %g, attendu %g\n", p, fitted[p], expected[p]);
+			failures++;
+		}
+	}
+	return failures;
+}
+
+// Trame du scope : entête (nouvelle capture) ou données à leur indice
+static void scope_frame(capture_t * cap, const uint8_t * data, int len) {
+	if (len < 2) return;
+
+	uint16_t index = get_u16(data);
+
+	if (index == SCOPE_HEADER_INDEX) {
+		if (len < 9) return;
+		cap->mask = data[2];
+		cap->n = 0;
+		for (uint8_t c = 0 ; c < SCOPE_CHANNELS ; c++) {
+			if (cap->mask & (1 << c)) cap->n++;
+		}
+		cap->depth = get_u16(&data[3]);
+		cap->received = 0;
+		if (cap->n == 0 || (uint32_t)cap->depth * cap->n > SCOPE_BUFFER_SIZE) cap->depth = 0;
+		return;
+	}
+
+	if (cap->depth == 0) return;
+
+	uint32_t count = (len - 2) / 2;
+	uint32_t first = (uint32_t)index * cap->n;
+
+	if (first + count > (uint32_t)cap->depth * cap->n) return;
+	for (uint32_t k = 0 ; k < count ; k++) {
+		cap->buf[first + k] = (int16_t)get_u16(&data[2 + 2 * k]);
+	}
+	cap->received += count / cap->n;
+}
+
+// Ajustement de chaque capture complète du flux
+static int fit_file(const char * path, const fit_cfg_t * cfg, int verify) {
+	static capture_t cap;
+	static uint8_t raw[1 << 20];
+	FILE * in = fopen(path, "rb");
+	int captures = 0;
+	int failures = 0;
+
+	if (in == NULL) {
+		perror(path);
+		return 1;
+	}
+	size_t size = fread(raw, 1, sizeof(raw), in);
+	fclose(in);
+
+	size_t begin = 0;
+
+	for (size_t p = 0 ; p <= size ; p++) {
+		if (p < size && raw[p] != 0) continue;
+
+		size_t len = p - begin;
+		uint8_t msg[COBS_ENCODED_MAX_SIZE(COBS_MSG_SIZE(DATA_MAX_SIZE))];
+
+		// Texte du shell ou trame d'un autre type : ignoré
+		if (len > 0 && len <= COBS_ENCODED_MAX_SIZE(COBS_MSG_SIZE(DATA_MAX_SIZE))) {
+			int n = cobs_frame_decode(&raw[begin], len, msg);
+
+			if (n >= 0 && msg[0] == SCOPE_REPLY) {
+				scope_frame(&cap, &msg[2], n);
+				if (cap.depth != 0 && cap.received == cap.depth) {
+					sysid_result_t res;
+
+					captures++;
+					if (fit(&cap, cfg, &res) != 0 || (verify && check(&res) != 0)) failures++;
+					cap.depth = 0;
+				}
+			}
+		}
+		begin = p + 1;
+	}
+
+	if (captures == 0) {
+		fprintf(stderr, "%s : aucune capture complete\n", path);
+		return 1;
+	}
+	return failures != 0;
+}
+
+static int sim_send(const uint8_t * data, uint16_t len) {
+	uint8_t frame[COBS_FRAME_MAX_SIZE(DATA_MAX_SIZE)];
+	uint16_t n = cobs_frame_encode(SCOPE_REPLY, sim_seq++, data, len, frame);
+
+	return fwrite(frame, 1, n, sim_out) == n ? 0 : -1;
+}
+
+// Essai "id" sur le moteur simulé, enregistré comme le reçoit l'hôte
+static int simulate(const char * path) {
+	static scope_t scope;
+	motor_sim_t m;
+	prbs_t prbs;
+
+	sim_out = fopen(path, "wb");
+	if (sim_out == NULL) {
+		perror(path);
+		return 1;
+	}
+	fputs("> id 0.3 0.1\r\n", sim_out);
+
+	motor_sim_init(&m);
+	prbs_init(&prbs, SIM_HOLD);
+	scope_init(&scope);
+	scope.mask = (1 << CH_ADC0) | (1 << CH_DUTY) | (1 << CH_DELTA);
+	scope.pre = 0;
+	scope_arm(&scope);
+	scope_force(&scope);
+
+	while (scope.state != SCOPE_DONE) {
+		motor_sim_sample_t s = motor_sim_step(&m, SIM_BIAS + SIM_AMPLITUDE * prbs_next(&prbs));
+		int16_t values[SCOPE_CHANNELS] = {0};
+
+		values[CH_ADC0] = s.adc;
+		values[CH_DUTY] = s.duty;
+		values[CH_DELTA] = s.delta;
+		scope_sample(&scope, values);
+	}
+	fputs("R = ...\r\n", sim_out);
+	while (scope_dump(&scope, sim_send, DATA_MAX_SIZE)) ;
+
+	return fclose(sim_out) != 0;
+}
+
+int main(int argc, char ** argv) {
+	fit_cfg_t cfg = {
+			.arr = MOTOR_SIM_ARR,
+			.te = MOTOR_SIM_TE,
+			.vbus = MOTOR_SIM_VBUS,
+			.ticks_per_rev = MOTOR_SIM_TICKS_PER_REV,
+			.block = 16,				// SYSID_BLOCK
+			.a_per_unit = MOTOR_SIM_A_PER_LSB
+	};
+	int sim = 0;
+	int verify = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "a:t:v:n:b:i:sx")) != -1) {
+		switch (opt) {
+		case 'a': cfg.arr = atoi(optarg); break;
+		case 't': cfg.te = atof(optarg); break;
+		case 'v': cfg.vbus = atof(optarg); break;
+		case 'n': cfg.ticks_per_rev = atoi(optarg); break;
+		case 'b': cfg.block = atoi(optarg); break;
+		case 'i': cfg.a_per_unit = atof(optarg); break;
+		case 's': sim = 1; break;
+		case 'x': verify = 1; break;
+		default:
+			fprintf(stderr, "sysid_fit [-a arr] [-t te] [-v vbus] [-n pas] [-b bloc] [-i A] [-s] [-x] capture.bin\n");
+			return 2;
+		}
+	}
+	if (optind != argc - 1) {
+		fprintf(stderr, "sysid_fit : fichier de capture attendu\n");
+		return 2;
+	}
+
+	return sim ? simulate(argv[optind]) : fit_file(argv[optind], &cfg, verify);
+}
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,45 @@
+/**
+ ******************************************************************************
+ * @file	test.h
+ * @brief	Assertions minimales des tests hôte
+ ******************************************************************************
+ *
+ * Une assertion en échec est affichée et comptée, le test continue.
+ * TEST_END() affiche le bilan et donne le code de retour de main().
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef TEST_H_
+#define TEST_H_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+
+/* Exported macros -----------------------------------------------------------*/
+static int test_checks = 0;
+static int test_failures = 0;
+
+#define CHECK(cond) do { \
+	test_checks++; \
+	if (!(cond)) { \
+		printf("%s:%d: echec : %s\n", __FILE__, __LINE__, #cond); \
+		test_failures++; \
+	} \
+} while (0)
+
+// |a - b| <= tol
+#define CHECK_NEAR(a, b, tol) do { \
+	double test_a = (a); \
+	double test_b = (b); \
+	test_checks++; \
+	if (!(fabs(test_a - test_b) <= (tol))) { \
+		printf("%s:%d: echec : %s = %g, attendu %g +/- %g\n", __FILE__, __LINE__, #a, test_a, test_b, (double)(tol)); \
+		test_failures++; \
+	} \
+} while (0)
+
+#define TEST_END() (printf("%d verifications, %d echecs\n", test_checks, test_failures), test_failures != 0)
+/* End of exported macros ----------------------------------------------------*/
+
+#endif /* TEST_H_ */
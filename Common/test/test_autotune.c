@@ -0,0 +1,199 @@
+/**
+ ******************************************************************************
+ * @file	test_autotune.c
+ * @brief	Test hôte du réglage au relais sur les boucles de courant et de vitesse
+ ******************************************************************************
+ *
+ * Chaque procédé est du premier ordre : y -> K.u / (1 + tau.s), échantillonné
+ * à te, la commande changeant delta après l'échantillon. Le cycle limite
+ * d'un relais symétrique (amplitude d, hystérésis eps, consigne 0) s'en
+ * déduit analytiquement (relay_cycle()) : N périodes par demi-cycle, la
+ * sortie à la bascule valant y0 = K.d.(1 - q) / (1 + q), q = exp(-N.te / tau),
+ * avec N le seul entier pour lequel l'échantillon qui précède la bascule
+ * franchit eps et pas le précédent. Alors Tu = 2.N.te, a est le plus grand
+ * échantillon autour de la bascule et Ku = 4.d / (pi.sqrt(a² - eps²)).
+ * Le pic continu, lui, tombe entre deux échantillons : a et surtout Ku
+ * (a proche de eps) s'en écarteraient bien au-delà de la tolérance.
+ *  - Courant : moteur RL rotor bloqué (motor_sim.h), K = Vbus / R,
+ *    tau = L / R, commande chargée une demi-période MLI après la mesure.
+ *  - Vitesse : J.dw/dt = ke.i - f.w, courant supposé suivre sa consigne
+ *    (boucle de courant bien plus rapide), K = ke / f, tau = J / f,
+ *    période 1 ms, commande appliquée dès l'échantillon.
+ * Tu, Ku et les gains PI (règle de CONTROL.h) sont comparés aux valeurs
+ * analytiques, puis le PI obtenu est essayé sur un échelon.
+ */
+
+#include "autotune.h"
+#include "pi.h"
+#include "motor_sim.h"
+#include "test.h"
+
+/* Macros --------------------------------------------------------------------*/
+#define TOL 0.05					// écart relatif admis sur Tu, Ku et les gains
+
+// Boucle de courant
+#define I_D 0.2						// relais sur u (AT_CURRENT_D)
+#define I_EPS 1.0					// A, cycle d'une vingtaine de périodes MLI
+#define I_K (MOTOR_SIM_VBUS / MOTOR_SIM_R)
+#define I_TAU (MOTOR_SIM_L / MOTOR_SIM_R)
+#define I_DELTA (0.5 * MOTOR_SIM_TE)	// CCR1 préchargé
+#define DUTY_MAX 0.95f
+
+// Boucle de vitesse
+#define W_TE 1e-3					// TIM6
+#define W_D 0.5						// A (AT_SPEED_D)
+#define W_EPS 10.0					// rad/s
+#define W_K (MOTOR_SIM_KE / MOTOR_SIM_F)
+#define W_TAU (MOTOR_SIM_J / MOTOR_SIM_F)
+#define I_MAX 5.0f					// CURRENT_I_MAX
+
+#define AT_TIMEOUT 5.0f
+/* End of macros -------------------------------------------------------------*/
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct{
+	double tu;
+	double ku;
+	double a;
+} cycle_t;
+
+typedef struct{
+	double w;
+	double a;					// exp(-te.f/J)
+} mech_t;
+/* End of types --------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+// Cycle limite exact de la boucle échantillonnée : le relais bascule delta
+// après l'échantillon qui franchit le seuil, N périodes par demi-cycle.
+// Sortie y(t) depuis la bascule vers -d (t = 0, y(0) = pic y0) :
+// y = -K.d + (y0 + K.d).exp(-t / tau), et y(N.te) = -y0 par symétrie.
+static cycle_t relay_cycle(double k, double tau, double te, double delta, double d, double eps) {
+	double kd = k * d;
+	cycle_t c = {0};
+
+	for (int n = 2 ; n < 100000 ; n++) {
+		double q = exp(-n * te / tau);
+		double y0 = kd * (1.0 - q) / (1.0 + q);
+
+		// Montée du demi-cycle précédent : y = K.d - (y0 + K.d).exp(-(t + N.te) / tau)
+		double y_detect = kd - (y0 + kd) * exp(-(n * te - delta) / tau);
+		double y_before = kd - (y0 + kd) * exp(-(n * te - delta - te) / tau);
+
+		if (y_detect > eps && y_before <= eps) {
+			// Échantillons encadrant le pic
+			double y_after = -kd + (y0 + kd) * exp(-(te - delta) / tau);
+
+			c.tu = 2.0 * n * te;
+			c.a = (y_detect > y_after) ? y_detect : y_after;
+			c.ku = 4.0 * d / (M_PI * sqrt(c.a * c.a - eps * eps));
+			return c;
+		}
+	}
+
+	return c;
+}
+
+// Gains attendus de la règle de Tyreus-Luyben (AT_RULE_TL)
+static void check_gains(const at_t * at, const cycle_t * c) {
+	float kp;
+	float ki;
+
+	CHECK(at_gains(at, AT_RULE_TL, &kp, &ki) == 0);
+	CHECK_NEAR(kp, c->ku / 3.2, TOL * c->ku / 3.2);
+	CHECK_NEAR(ki, c->ku / 3.2 / (2.2 * c->tu), 2 * TOL * c->ku / 3.2 / (2.2 * c->tu));
+}
+
+static float current_meas(motor_sim_t * m) {
+	return (float)(motor_sim_sample(m).adc * MOTOR_SIM_A_PER_LSB);
+}
+
+// Une période de la boucle de vitesse, courant i appliqué jusqu'à la suivante
+static float mech_step(mech_t * p, float i) {
+	p->w = p->a * p->w + (1.0 - p->a) * W_K * i;
+	return (float)p->w;
+}
+
+int main() {
+	at_t at;
+	motor_sim_t m;
+	cycle_t c;
+	float y;
+	float kp;
+	float ki;
+	int k;
+
+	// Boucle de courant : relais sur u, mesure à chaque séquence ADC
+	motor_sim_init(&m);
+	m.locked = 1;
+	at_start(&at, 0.0f, 0.0f, I_D, I_EPS, (float)MOTOR_SIM_TE, AT_TIMEOUT);
+	y = 0.0f;
+	for (k = 0 ; at.state == AT_RUNNING ; k++) {
+		motor_sim_write(&m, at_update(&at, y));
+		y = current_meas(&m);
+	}
+	c = relay_cycle(I_K, I_TAU, MOTOR_SIM_TE, I_DELTA, I_D, I_EPS);
+	printf("courant : Tu = %.3f ms (%.3f), a = %.3f A (%.3f), Ku = %.4f (%.4f)\n",
+			at.tu * 1e3, c.tu * 1e3, at.a, c.a, at.ku, c.ku);
+	CHECK(at.state == AT_DONE);
+	CHECK_NEAR(at.tu, c.tu, TOL * c.tu);
+	CHECK_NEAR(at.a, c.a, TOL * c.a);
+	CHECK_NEAR(at.ku, c.ku, TOL * c.ku);
+	check_gains(&at, &c);
+
+	// PI réglé : échelon de 2 A, sans oscillation entretenue ni erreur statique
+	pi_t pi;
+	double peak = 0.0;
+
+	CHECK(at_gains(&at, AT_RULE_TL, &kp, &ki) == 0);
+	pi_init(&pi, kp, ki, (float)MOTOR_SIM_TE, -DUTY_MAX, DUTY_MAX);
+	y = current_meas(&m);
+	for (k = 0 ; k < 2000 ; k++) {
+		motor_sim_write(&m, pi_update(&pi, 2.0f - y, 0.0f));
+		y = current_meas(&m);
+		if (y > peak) peak = y;
+	}
+	CHECK(peak < 2.0 * 1.3);
+	CHECK_NEAR(y, 2.0, 0.01);
+
+	// Boucle de vitesse : relais sur la consigne de courant
+	mech_t p = {0.0, exp(-W_TE / W_TAU)};
+
+	at_start(&at, 0.0f, 0.0f, W_D, W_EPS, (float)W_TE, AT_TIMEOUT);
+	y = 0.0f;
+	while (at.state == AT_RUNNING) y = mech_step(&p, at_update(&at, y));
+	c = relay_cycle(W_K, W_TAU, W_TE, 0.0, W_D, W_EPS);
+	printf("vitesse : Tu = %.3f ms (%.3f), a = %.3f rad/s (%.3f), Ku = %.5f (%.5f)\n",
+			at.tu * 1e3, c.tu * 1e3, at.a, c.a, at.ku, c.ku);
+	CHECK(at.state == AT_DONE);
+	CHECK_NEAR(at.tu, c.tu, TOL * c.tu);
+	CHECK_NEAR(at.a, c.a, TOL * c.a);
+	CHECK_NEAR(at.ku, c.ku, TOL * c.ku);
+	check_gains(&at, &c);
+
+	// PI réglé : échelon de 50 rad/s
+	CHECK(at_gains(&at, AT_RULE_TL, &kp, &ki) == 0);
+	pi_init(&pi, kp, ki, (float)W_TE, -I_MAX, I_MAX);
+	peak = 0.0;
+	for (k = 0 ; k < 2000 ; k++) {
+		y = mech_step(&p, pi_update(&pi, 50.0f - y, 0.0f));
+		if (y > peak) peak = y;
+	}
+	CHECK(peak < 50.0 * 1.3);
+	CHECK_NEAR(y, 50.0, 0.5);
+
+	// Hystérésis au-delà de la plage atteignable : pas de cycle, échec au délai
+	at_start(&at, 0.0f, 0.0f, W_D, (float)(2.0 * W_K * W_D), (float)W_TE, 0.5f);
+	p.w = 0.0;
+	y = 0.0f;
+	for (k = 0 ; at.state == AT_RUNNING ; k++) y = mech_step(&p, at_update(&at, y));
+	CHECK(at.state == AT_FAILED);
+	CHECK(k * W_TE <= 0.5 + W_TE);
+	CHECK(at_gains(&at, AT_RULE_TL, &kp, &ki) != 0);
+	CHECK(at_update(&at, y) == 0.0f);
+
+	return TEST_END();
+}
+
+/* End of functions ----------------------------------------------------------*/
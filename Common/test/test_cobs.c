@@ -0,0 +1,118 @@
+/**
+ ******************************************************************************
+ * @file	test_cobs.c
+ * @brief	Test hôte des trames : vecteurs COBS et CRC, aller-retour, erreurs
+ ******************************************************************************
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "cobs.h"
+#include "test.h"
+
+/* Functions -----------------------------------------------------------------*/
+
+static int encoded_equals(const uint8_t * src, uint16_t len, const uint8_t * ref, uint16_t ref_len) {
+	uint8_t dst[300];
+	uint16_t n = cobs_encode(src, len, dst);
+
+	return n == ref_len && !memcmp(dst, ref, n);
+}
+
+int main() {
+	static uint8_t data[600];
+	static uint8_t enc[COBS_ENCODED_MAX_SIZE(600)];
+	static uint8_t dec[COBS_ENCODED_MAX_SIZE(600)];
+	static uint8_t frame[COBS_FRAME_MAX_SIZE(600)];
+	int n;
+
+	// CRC-16/CCITT-FALSE : valeur de contrôle du catalogue
+	CHECK(cobs_crc16((const uint8_t *)"123456789", 9, COBS_CRC_INIT) == 0x29B1);
+	CHECK(cobs_crc16((const uint8_t *)"12345", 5, cobs_crc16(NULL, 0, COBS_CRC_INIT)) ==
+			cobs_crc16((const uint8_t *)"12345", 5, COBS_CRC_INIT));
+	CHECK(cobs_crc16((const uint8_t *)"6789", 4, cobs_crc16((const uint8_t *)"12345", 5, COBS_CRC_INIT)) == 0x29B1);
+
+	// Vecteurs COBS de référence
+	static const uint8_t v1[] = {0x00};
+	static const uint8_t r1[] = {0x01, 0x01};
+	static const uint8_t v2[] = {0x00, 0x00};
+	static const uint8_t r2[] = {0x01, 0x01, 0x01};
+	static const uint8_t v3[] = {0x11, 0x22, 0x00, 0x33};
+	static const uint8_t r3[] = {0x03, 0x11, 0x22, 0x02, 0x33};
+	static const uint8_t v4[] = {0x11, 0x22, 0x33, 0x44};
+	static const uint8_t r4[] = {0x05, 0x11, 0x22, 0x33, 0x44};
+	static const uint8_t v5[] = {0x11, 0x00, 0x00, 0x00};
+	static const uint8_t r5[] = {0x02, 0x11, 0x01, 0x01, 0x01};
+
+	CHECK(encoded_equals(v1, sizeof(v1), r1, sizeof(r1)));
+	CHECK(encoded_equals(v2, sizeof(v2), r2, sizeof(r2)));
+	CHECK(encoded_equals(v3, sizeof(v3), r3, sizeof(r3)));
+	CHECK(encoded_equals(v4, sizeof(v4), r4, sizeof(r4)));
+	CHECK(encoded_equals(v5, sizeof(v5), r5, sizeof(r5)));
+
+	// 254 octets non nuls : un bloc plein (0xFF), puis le code final
+	for (int i = 0 ; i < 254 ; i++) data[i] = i + 1;
+	n = cobs_encode(data, 254, enc);
+	CHECK(n == 256 && enc[0] == 0xFF && enc[255] == 0x01);
+	CHECK(cobs_decode(enc, n, dec) == 254 && !memcmp(dec, data, 254));
+
+	// Aller-retour aléatoire, jamais de 0x00 dans le codage, borne respectée
+	srand(1);
+	for (int t = 0 ; t < 2000 ; t++) {
+		uint16_t len = rand() % 600;
+		int zeros = rand() % 4;
+		int ok = 1;
+
+		for (uint16_t i = 0 ; i < len ; i++) {
+			data[i] = zeros == 0 ? (rand() % 255) + 1 : rand() % (zeros * 4);
+		}
+		n = cobs_encode(data, len, enc);
+		if (n > COBS_ENCODED_MAX_SIZE(len) || memchr(enc, 0, n) != NULL) ok = 0;
+		if (cobs_decode(enc, n, dec) != len || memcmp(dec, data, len)) ok = 0;
+		CHECK(ok);
+		if (!ok) break;
+	}
+
+	// Trame complète : délimiteurs, décodage, type, seq et données
+	for (int i = 0 ; i < 64 ; i++) data[i] = i * 7;
+	uint16_t len = cobs_frame_encode(0x03, 42, data, 64, frame);
+	CHECK(len <= COBS_FRAME_MAX_SIZE(64));
+	CHECK(frame[0] == 0 && frame[len - 1] == 0 && memchr(&frame[1], 0, len - 2) == NULL);
+	n = cobs_frame_decode(&frame[1], len - 2, dec);
+	CHECK(n == 64 && dec[0] == 0x03 && dec[1] == 42 && !memcmp(&dec[2], data, 64));
+
+	// Trame sans données
+	len = cobs_frame_encode(0x81, 0, NULL, 0, frame);
+	CHECK(cobs_frame_decode(&frame[1], len - 2, dec) == 0 && dec[0] == 0x81);
+
+	// Toute inversion d'un bit d'un octet est détectée (COBS ou CRC)
+	len = cobs_frame_encode(0x01, 7, data, 16, frame);
+	int detected = 1;
+	for (uint16_t i = 1 ; i < len - 1 ; i++) {
+		for (int b = 0 ; b < 8 ; b++) {
+			frame[i] ^= 1 << b;
+			if (frame[i] != 0 && cobs_frame_decode(&frame[1], len - 2, dec) >= 0) detected = 0;
+			frame[i] ^= 1 << b;
+		}
+	}
+	CHECK(detected);
+
+	// Codage invalide : 0x00 dans la trame, bloc tronqué, message trop court
+	static const uint8_t bad1[] = {0x03, 0x11, 0x00, 0x22};
+	static const uint8_t bad2[] = {0x05, 0x11, 0x22};
+	static const uint8_t bad3[] = {0x04, 0x11, 0x22, 0x33};
+	CHECK(cobs_decode(bad1, sizeof(bad1), dec) == -1);
+	CHECK(cobs_decode(bad2, sizeof(bad2), dec) == -1);
+	CHECK(cobs_frame_decode(bad2, sizeof(bad2), dec) == COBS_ERR_CODING);
+	CHECK(cobs_frame_decode(bad3, sizeof(bad3), dec) == COBS_ERR_CODING);
+
+	// CRC faux sur un codage valide
+	static const uint8_t msg[] = {0x01, 0x02, 0x03, 0x04, 0x05};
+	n = cobs_encode(msg, sizeof(msg), enc);
+	CHECK(cobs_frame_decode(enc, n, dec) == COBS_ERR_CRC);
+
+	return TEST_END();
+}
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,100 @@
+/**
+ ******************************************************************************
+ * @file	test_encoder.c
+ * @brief	Test hôte de la position codeur : débordements du compteur 32 bits
+ ******************************************************************************
+ *
+ * Référence : position 64 bits cumulée, tours et angle par division
+ * euclidienne. Le compteur simulé part juste sous 2^32 pour traverser le
+ * débordement dans les deux sens.
+ */
+
+#include <stdlib.h>
+
+#include "encoder.h"
+#include "test.h"
+
+/* Macros --------------------------------------------------------------------*/
+#define TPR 4096				// pas par tour (codeur 1024 points, x4)
+/* End of macros -------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+// Tours et angle de référence, arrondi vers -inf
+static int snapshot_matches(const enc_snapshot_t * s, int64_t pos, uint32_t samples) {
+	int64_t rev = pos / TPR;
+	int64_t angle = pos % TPR;
+
+	if (angle < 0) {
+		angle += TPR;
+		rev--;
+	}
+
+	return s->position == pos && s->revolutions == rev && s->angle == angle
+			&& s->samples == samples;
+}
+
+int main() {
+	enc_t enc;
+	enc_snapshot_t s;
+	uint32_t cnt = 0xFFFFFF00u;
+	int64_t pos = 0;
+	int ok = 1;
+
+	enc_init(&enc, cnt, TPR);
+	enc_get(&enc, &s);
+	CHECK(snapshot_matches(&s, 0, 0));
+
+	// Traversée du débordement en montée, puis en descente
+	cnt += 0x200;
+	CHECK(enc_update(&enc, cnt) == 0x200);
+	pos += 0x200;
+	enc_get(&enc, &s);
+	CHECK(snapshot_matches(&s, pos, 1) && s.delta == 0x200);
+
+	cnt -= 0x300;
+	CHECK(enc_update(&enc, cnt) == -0x300);
+	pos -= 0x300;
+	enc_get(&enc, &s);
+	CHECK(snapshot_matches(&s, pos, 2) && s.revolutions == -1 && s.angle == TPR - 0x100);
+
+	// Marche aléatoire : pas de ±(2^31 - 1) au plus, plusieurs tours du compteur
+	srand(1);
+	for (uint32_t k = 3 ; k < 200000 && ok ; k++) {
+		int32_t step;
+
+		switch (k % 4) {
+		case 0: step = (rand() % 2001) - 1000; break;
+		case 1: step = (rand() % (2 * TPR + 1)) - TPR; break;
+		case 2: step = (int32_t)(((uint32_t)rand() << 8) ^ rand()) % 100000000; break;
+		default: step = (k & 8) ? INT32_MAX : -INT32_MAX; break;
+		}
+		cnt += (uint32_t)step;
+		pos += step;
+		ok = enc_update(&enc, cnt) == step;
+		enc_get(&enc, &s);
+		ok = ok && snapshot_matches(&s, pos, k) && s.delta == step;
+	}
+	CHECK(ok);
+
+	// Position au-delà de 2^32 pas : le compteur a fait plusieurs tours
+	enc_init(&enc, 0, TPR);
+	cnt = 0;
+	for (int k = 0 ; k < 10 ; k++) {
+		cnt += 0x40000000u;
+		enc_update(&enc, cnt);
+	}
+	enc_get(&enc, &s);
+	CHECK(s.position == 10LL * 0x40000000);
+	CHECK(s.revolutions == 10LL * 0x40000000 / TPR && s.angle == 0);
+
+	// Tampons alternés : la copie suit toujours le dernier publié
+	CHECK(enc.seq == 10);
+	enc_update(&enc, cnt + 1);
+	enc_get(&enc, &s);
+	CHECK(s.delta == 1 && s.samples == 11);
+
+	return TEST_END();
+}
+
+/* End of functions ----------------------------------------------------------*/
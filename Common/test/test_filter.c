@@ -0,0 +1,130 @@
+/**
+ ******************************************************************************
+ * @file	test_filter.c
+ * @brief	Test hôte des filtres en virgule fixe contre une référence double
+ ******************************************************************************
+ *
+ * Échelon, impulsion et bruit pleine échelle, pour chaque type et chaque
+ * ordre. Écarts admis à la référence double (en LSB) :
+ *  - FILT_MA : somme exacte, arrondi de sortie seul : 0,5 ;
+ *  - FILT_IIR : arrondi de sortie plus troncature Q8 de chaque pas, dont
+ *    l'effet cumulé reste sous 2^order / 256 (série géométrique).
+ */
+
+#include <stdint.h>
+
+#include "filter.h"
+#include "test.h"
+
+/* Macros --------------------------------------------------------------------*/
+#define N 2000						// échantillons par signal
+#define SIGNALS 3
+/* End of macros -------------------------------------------------------------*/
+
+/* Variables -----------------------------------------------------------------*/
+static uint32_t lcg = 12345;
+/* End of variables ----------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static uint16_t noise() {
+	lcg = lcg * 1664525 + 1013904223;
+	return lcg >> 16;
+}
+
+// Signal s, échantillon k
+static uint16_t input(int s, int k) {
+	switch (s) {
+	case 0: return (k < 10) ? 1000 : 50000;		// échelon
+	case 1: return (k == 10) ? 65535 : 0;		// impulsion
+	default: return noise();					// bruit uniforme 16 bits
+	}
+}
+
+// Écart maximal au filtre double sur un signal, l'état partant du premier échantillon
+static double max_error(uint8_t type, uint8_t order, int s) {
+	filt_t f;
+	double ref = 0.0;
+	double hist[1 << FILT_MA_MAX_ORDER];
+	double err = 0.0;
+	int len = 1 << order;
+
+	filt_init(&f);
+	CHECK(filt_config(&f, type, order) == 0);
+
+	for (int k = 0 ; k < N ; k++) {
+		uint16_t x = input(s, k);
+		double y;
+
+		if (type == FILT_IIR) {
+			if (k == 0) ref = x;
+			ref += (x - ref) / len;
+			y = ref;
+		}
+		else {
+			if (k == 0) {
+				for (int i = 0 ; i < len ; i++) hist[i] = x;
+			}
+			y = 0.0;
+			hist[k % len] = x;
+			for (int i = 0 ; i < len ; i++) y += hist[i];
+			y /= len;
+		}
+
+		double e = fabs(filt_update(&f, x) - y);
+
+		if (e > err) err = e;
+	}
+
+	return err;
+}
+
+int main() {
+	filt_t f;
+
+	// Configurations refusées, sans effet sur le filtre
+	filt_init(&f);
+	CHECK(filt_config(&f, FILT_IIR, 0) != 0);
+	CHECK(filt_config(&f, FILT_IIR, FILT_IIR_MAX_ORDER + 1) != 0);
+	CHECK(filt_config(&f, FILT_MA, 0) != 0);
+	CHECK(filt_config(&f, FILT_MA, FILT_MA_MAX_ORDER + 1) != 0);
+	CHECK(filt_config(&f, FILT_MA + 1, 1) != 0);
+	CHECK(f.req == 0);
+	CHECK(filt_update(&f, 1234) == 1234);
+
+	for (uint8_t order = 1 ; order <= FILT_IIR_MAX_ORDER ; order++) {
+		for (int s = 0 ; s < SIGNALS ; s++) {
+			double err = max_error(FILT_IIR, order, s);
+
+			CHECK(err <= 0.5 + (double)(1 << order) / 256.0);
+		}
+	}
+	for (uint8_t order = 1 ; order <= FILT_MA_MAX_ORDER ; order++) {
+		for (int s = 0 ; s < SIGNALS ; s++) {
+			CHECK(max_error(FILT_MA, order, s) <= 0.5);
+		}
+	}
+
+	// Changement en marche : appliqué au filt_update() suivant, l'état
+	// repart de l'échantillon courant, puis retour sans filtrage
+	filt_init(&f);
+	for (int k = 0 ; k < 10 ; k++) filt_update(&f, 100);
+	CHECK(filt_config(&f, FILT_MA, 2) == 0);
+	CHECK(filt_update(&f, 2000) == 2000);
+	CHECK(filt_update(&f, 0) == 1500);
+	CHECK(filt_config(&f, FILT_IIR, 1) == 0);
+	CHECK(filt_update(&f, 400) == 400);
+	CHECK(filt_update(&f, 0) == 200);
+	CHECK(filt_config(&f, FILT_NONE, 0) == 0);
+	CHECK(filt_update(&f, 777) == 777);
+
+	// Pleine échelle sans débordement de l'état
+	CHECK(filt_config(&f, FILT_IIR, FILT_IIR_MAX_ORDER) == 0);
+	for (int k = 0 ; k < 100 ; k++) CHECK(filt_update(&f, 65535) == 65535);
+	CHECK(filt_config(&f, FILT_MA, FILT_MA_MAX_ORDER) == 0);
+	for (int k = 0 ; k < 100 ; k++) CHECK(filt_update(&f, 65535) == 65535);
+
+	return TEST_END();
+}
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,134 @@
+/**
+ ******************************************************************************
+ * @file	test_fmt.c
+ * @brief	Test hôte du formatage et de la lecture en virgule fixe
+ ******************************************************************************
+ *
+ * Référence : snprintf de la libc, sur des valeurs limites et aléatoires.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "fmt.h"
+#include "test.h"
+
+/* Variables -----------------------------------------------------------------*/
+static char out[256];
+static size_t out_len = 0;
+/* End of variables ----------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static int out_write(char * s, uint16_t size) {
+	memcpy(&out[out_len], s, size);
+	out_len += size;
+	out[out_len] = '\0';
+	return size;
+}
+
+// fmt_fixed contre snprintf, sur la valeur entière 64 bits
+static int fixed_matches(int32_t v, uint8_t decimals) {
+	static const int64_t p[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+	char b[FMT_FIXED_MAX_SIZE];
+	char ref[300];				// decimals < 256 : pas de troncature possible
+	int64_t a = v < 0 ? -(int64_t)v : v;
+	int len = fmt_fixed(b, v, decimals);
+
+	if (decimals == 0) snprintf(ref, sizeof(ref), "%s%lld", v < 0 ? "-" : "", (long long)a);
+	else snprintf(ref, sizeof(ref), "%s%lld.%0*lld", v < 0 ? "-" : "",
+			(long long)(a / p[decimals]), decimals, (long long)(a % p[decimals]));
+
+	return len == (int)strlen(b) && !strcmp(b, ref);
+}
+
+int main() {
+	char b[FMT_FIXED_MAX_SIZE];
+	int32_t v;
+
+	// Entiers : limites
+	CHECK(fmt_u32(b, 0) == 1 && !strcmp(b, "0"));
+	CHECK(fmt_u32(b, UINT32_MAX) == 10 && !strcmp(b, "4294967295"));
+	CHECK(fmt_i32(b, INT32_MIN) == 11 && !strcmp(b, "-2147483648"));
+	CHECK(fmt_i32(b, -1) == 2 && !strcmp(b, "-1"));
+
+	// Virgule fixe : zéros de tête des décimales, signe sous l'unité
+	CHECK(fmt_fixed(b, 1234, 2) == 5 && !strcmp(b, "12.34"));
+	CHECK(fmt_fixed(b, 5, 3) == 5 && !strcmp(b, "0.005"));
+	CHECK(fmt_fixed(b, -5, 3) == 6 && !strcmp(b, "-0.005"));
+	CHECK(fmt_fixed(b, 42, 0) == 2 && !strcmp(b, "42"));
+	CHECK(fmt_fixed(b, INT32_MIN, 9) == 12 && !strcmp(b, "-2.147483648"));
+	CHECK(fixed_matches(INT32_MAX, 4));
+
+	srand(1);
+	int ok = 1;
+	for (int i = 0 ; i < 100000 && ok ; i++) {
+		v = (int32_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand());
+		ok = fixed_matches(v, i % 10) && fixed_matches(v >> (i % 31), i % 10);
+	}
+	CHECK(ok);
+
+	// Q16.16 arrondi au plus proche
+	CHECK(fmt_q16(b, 0x00018000, 1) == 3 && !strcmp(b, "1.5"));
+	CHECK(fmt_q16(b, -0x00018000, 2) == 5 && !strcmp(b, "-1.50"));
+	CHECK(fmt_q16(b, 0x0000FFFF, 2) == 4 && !strcmp(b, "1.00"));
+	CHECK(fmt_q16(b, -1, 2) == 4 && !strcmp(b, "0.00"));
+	CHECK(fmt_q16(b, 1 << 16, 0) == 1 && !strcmp(b, "1"));
+
+	// Lecture : signes, décimales partielles et tronquées
+	CHECK(fmt_parse_fixed("12.5", 2, &v) == 0 && v == 1250);
+	CHECK(fmt_parse_fixed("-0.05", 2, &v) == 0 && v == -5);
+	CHECK(fmt_parse_fixed("+3", 3, &v) == 0 && v == 3000);
+	CHECK(fmt_parse_fixed(".25", 2, &v) == 0 && v == 25);
+	CHECK(fmt_parse_fixed("7.", 1, &v) == 0 && v == 70);
+	CHECK(fmt_parse_fixed("1.999", 1, &v) == 0 && v == 19);
+	CHECK(fmt_parse_fixed("2147483647", 0, &v) == 0 && v == INT32_MAX);
+	CHECK(fmt_parse_fixed("-2147483647", 0, &v) == 0 && v == -INT32_MAX);
+	CHECK(fmt_parse_fixed("21474836.47", 2, &v) == 0 && v == INT32_MAX);
+
+	// Refus : syntaxe, nombre de décimales, débordement
+	v = 99;
+	CHECK(fmt_parse_fixed("", 0, &v) == -1);
+	CHECK(fmt_parse_fixed("-", 0, &v) == -1);
+	CHECK(fmt_parse_fixed(".", 2, &v) == -1);
+	CHECK(fmt_parse_fixed("1.2.3", 2, &v) == -1);
+	CHECK(fmt_parse_fixed("12a", 0, &v) == -1);
+	CHECK(fmt_parse_fixed("1 ", 0, &v) == -1);
+	CHECK(fmt_parse_fixed("1", 10, &v) == -1);
+	CHECK(fmt_parse_fixed("2147483648", 0, &v) == -1);
+	CHECK(fmt_parse_fixed("99999999999", 0, &v) == -1);
+	CHECK(fmt_parse_fixed("21474836.48", 2, &v) == -1);
+	CHECK(fmt_parse_fixed("21474836.99", 2, &v) == -1);
+	CHECK(fmt_parse_fixed("-21474836.99", 2, &v) == -1);
+	CHECK(fmt_parse_fixed("2.2", 9, &v) == -1);
+	CHECK(v == 99);
+
+	// Aller-retour fmt_fixed -> fmt_parse_fixed
+	ok = 1;
+	for (int i = 0 ; i < 100000 && ok ; i++) {
+		int32_t w;
+
+		v = (int32_t)(((uint32_t)rand() << 16) ^ (uint32_t)rand());
+		if (v == INT32_MIN) continue;
+		fmt_fixed(b, v, i % 10);
+		ok = fmt_parse_fixed(b, i % 10, &w) == 0 && w == v;
+	}
+	CHECK(ok);
+
+	// Sortie : rien sans fmt_set_output, puis écriture directe
+	fmt_puts("perdu");
+	fmt_set_output(out_write);
+	fmt_puts("v=");
+	fmt_put_fixed(-1234, 3);
+	fmt_puts(" n=");
+	fmt_put_u32(7);
+	fmt_puts(" i=");
+	fmt_put_i32(-8);
+	fmt_puts(" q=");
+	fmt_put_q16(3 << 15, 1);
+	CHECK(!strcmp(out, "v=-1.234 n=7 i=-8 q=1.5"));
+
+	return TEST_END();
+}
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,122 @@
+/**
+ ******************************************************************************
+ * @file	test_pi.c
+ * @brief	Test hôte du régulateur PI : boucle de courant contre un modèle RL
+ ******************************************************************************
+ *
+ * Modèle : L.di/dt = u.VBUS - R.i - e, intégré exactement sur une période
+ * MLI (commande bloquée), commande appliquée à la période suivante comme sur
+ * la cible. Gains et bornes de CONTROL.h (TP), Te de la MLI par défaut.
+ */
+
+#include <math.h>
+
+#include "pi.h"
+#include "test.h"
+
+/* Macros --------------------------------------------------------------------*/
+#define VBUS 24.0				// V
+#define R 1.0					// ohm
+#define L 1e-3					// H
+#define TE (5.0 * 2 * 1024 / 170e6)	// MLI centrée, ~60 µs
+
+#define KP 0.05f				// CURRENT_KP
+#define KI 100.0f				// CURRENT_KI
+#define DUTY_MAX 0.95f
+/* End of macros -------------------------------------------------------------*/
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct{
+	double i;
+	double e;					// force contre-électromotrice
+	double u;					// commande de la période en cours
+} rl_t;
+/* End of types --------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static void rl_step(rl_t * m) {
+	double a = exp(-R * TE / L);
+	double v = m->u * VBUS - m->e;
+
+	m->i = m->i * a + (1.0 - a) * v / R;
+}
+
+// Une période : mesure, régulation, puis évolution du moteur
+static float loop_step(pi_t * pi, rl_t * m, float i_ref) {
+	float u = pi_update(pi, i_ref - (float)m->i, 0.0f);
+
+	rl_step(m);
+	m->u = u;
+	return u;
+}
+
+int main() {
+	pi_t pi;
+	rl_t m = {0};
+	int n10 = -1;
+	double peak = 0.0;
+	int k;
+
+	pi_init(&pi, KP, KI, (float)TE, -DUTY_MAX, DUTY_MAX);
+
+	// Échelon de 2 A : temps de réponse, dépassement, erreur statique nulle
+	for (k = 0 ; k < 2000 ; k++) {
+		loop_step(&pi, &m, 2.0f);
+		if (m.i > peak) peak = m.i;
+		if (n10 < 0 && fabs(m.i - 2.0) < 0.02 * 2.0) n10 = k;
+	}
+	CHECK(n10 >= 0 && n10 * TE < 5e-3);
+	CHECK(peak < 2.0 * 1.2);
+	CHECK_NEAR(m.i, 2.0, 1e-3);
+	CHECK_NEAR(pi.integ * VBUS, R * 2.0, 1e-3);
+
+	// Perturbation de fcem : rejetée par l'intégrale
+	m.e = 5.0;
+	for (k = 0 ; k < 4000 ; k++) loop_step(&pi, &m, 2.0f);
+	CHECK_NEAR(m.i, 2.0, 1e-3);
+	CHECK_NEAR(pi.out * VBUS, R * 2.0 + 5.0, 1e-2);
+
+	// Consigne inatteignable : sortie et intégrale bornées
+	m.e = 0.0;
+	for (k = 0 ; k < 4000 ; k++) loop_step(&pi, &m, 100.0f);
+	CHECK(pi.out == DUTY_MAX);
+	CHECK(pi.integ <= DUTY_MAX);
+	CHECK_NEAR(m.i, DUTY_MAX * VBUS / R, 1e-2);
+
+	// Anti-windup : retour à 1 A sans traîner l'intégrale accumulée en butée
+	int back = -1;
+	for (k = 0 ; k < 2000 ; k++) {
+		loop_step(&pi, &m, 1.0f);
+		if (back < 0 && fabs(m.i - 1.0) < 0.05) back = k;
+	}
+	CHECK(back >= 0 && back * TE < 10e-3);
+	CHECK_NEAR(m.i, 1.0, 1e-3);
+
+	// Saturation basse, symétrique
+	for (k = 0 ; k < 4000 ; k++) loop_step(&pi, &m, -100.0f);
+	CHECK(pi.out == -DUTY_MAX && pi.integ >= -DUTY_MAX);
+
+	// Intégrale gelée en butée dans le sens de l'erreur, libérée en sens inverse
+	pi_init(&pi, 0.0f, KI, (float)TE, -0.5f, 0.5f);
+	pi_reset(&pi, 0.5f);
+	pi_update(&pi, 1.0f, 0.0f);
+	CHECK(pi.integ == 0.5f && pi.out == 0.5f);
+	pi_update(&pi, -1.0f, 0.0f);
+	CHECK(pi.integ < 0.5f);
+
+	// Anticipation ajoutée à la sortie, bornée avec elle
+	pi_init(&pi, 0.0f, 0.0f, (float)TE, -1.0f, 1.0f);
+	CHECK(pi_update(&pi, 0.0f, 0.25f) == 0.25f);
+	CHECK(pi_update(&pi, 0.0f, 3.0f) == 1.0f);
+
+	// Reprise sans à-coup : la sortie part de la valeur préchargée
+	pi_init(&pi, KP, KI, (float)TE, -DUTY_MAX, DUTY_MAX);
+	pi_reset(&pi, 0.3f);
+	CHECK(pi.out == 0.3f);
+	CHECK_NEAR(pi_update(&pi, 0.0f, 0.0f), 0.3, 1e-6);
+
+	return TEST_END();
+}
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,179 @@
+/**
+ ******************************************************************************
+ * @file	test_sched.c
+ * @brief	Test hôte de l'exécutif sur horloge virtuelle
+ ******************************************************************************
+ *
+ * L'horloge de l'exécutif est une variable : chaque tâche l'avance de sa
+ * durée simulée, le test la règle avant sched_run() pour fixer la latence.
+ * Libérations, ordre d'exécution, latences, échéances manquées,
+ * dépassements, mode dégradé et sortie par sched_clear().
+ */
+
+#include <stddef.h>
+
+#include "sched.h"
+#include "test.h"
+
+/* Macros --------------------------------------------------------------------*/
+#define TASK_A 0					// essentielle
+#define TASK_B 1
+/* End of macros -------------------------------------------------------------*/
+
+/* Variables -----------------------------------------------------------------*/
+static uint32_t now = 0;
+static uint32_t cost[2];			// durée simulée de chaque tâche
+static uint8_t trace[16];			// ordre d'exécution
+static uint8_t traced = 0;
+static int fallbacks = 0;
+static uint8_t fallback_task = 0xFF;
+/* End of variables ----------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static uint32_t clock_virtual() {
+	return now;
+}
+
+static void run(uint8_t task) {
+	now += cost[task];
+	if (traced < sizeof(trace)) trace[traced++] = task;
+}
+
+static void task_a() {
+	run(TASK_A);
+}
+
+static void task_b() {
+	run(TASK_B);
+}
+
+static void fallback(uint8_t task) {
+	fallbacks++;
+	fallback_task = task;
+}
+
+static void nop() {
+}
+
+// n ticks, chacun suivi d'un sched_run() latency unités plus tard
+static void ticks(sched_t * s, int n, uint32_t latency) {
+	for (int k = 0 ; k < n ; k++) {
+		sched_tick(s);
+		now += latency;
+		sched_run(s);
+	}
+}
+
+int main() {
+	sched_t s;
+
+	// Paramètres invalides et table pleine
+	sched_init(&s, clock_virtual, NULL);
+	CHECK(sched_add(&s, "p0", nop, 0, 0, 10, 0) == -1);
+	CHECK(sched_add(&s, "off", nop, 4, 4, 10, 0) == -1);
+	for (int i = 0 ; i < SCHED_MAX_TASKS ; i++) CHECK(sched_add(&s, "t", nop, 1, 0, 10, 0) == i);
+	CHECK(sched_add(&s, "t", nop, 1, 0, 10, 0) == -1);
+
+	// Libérations aux ticks offset + k.period, ordre d'enregistrement
+	sched_init(&s, clock_virtual, fallback);
+	CHECK(sched_add(&s, "a", task_a, 2, 0, 100, SCHED_ESSENTIAL) == TASK_A);
+	CHECK(sched_add(&s, "b", task_b, 4, 1, 100, 0) == TASK_B);
+	cost[TASK_A] = 10;
+	cost[TASK_B] = 20;
+
+	// Ticks 0..7 : a en 0, 2, 4, 6 ; b en 1, 5
+	ticks(&s, 8, 5);
+	CHECK(s.tick == 8);
+	CHECK(s.tasks[TASK_A].runs == 4);
+	CHECK(s.tasks[TASK_B].runs == 2);
+	CHECK(traced == 6);
+	CHECK(trace[0] == TASK_A && trace[1] == TASK_B && trace[2] == TASK_A);
+	CHECK(s.tasks[TASK_A].exec_last == 10 && s.tasks[TASK_B].exec_max == 20);
+	CHECK(s.tasks[TASK_A].latency_min == 5 && s.tasks[TASK_A].latency_max == 5);
+
+	// Même tick : a puis b, b démarre après la fin de a (latence + durée de a)
+	sched_clear(&s);
+	traced = 0;
+	s.tasks[TASK_A].countdown = 0;
+	s.tasks[TASK_B].countdown = 0;
+	sched_tick(&s);
+	now += 3;
+	CHECK(sched_run(&s) == 2);
+	CHECK(sched_run(&s) == 0);
+	CHECK(traced == 2 && trace[0] == TASK_A && trace[1] == TASK_B);
+	CHECK(s.tasks[TASK_A].latency_max == 3);
+	CHECK(s.tasks[TASK_B].latency_max == 3 + 10);
+
+	// Jitter : latences différentes d'une libération à l'autre
+	sched_clear(&s);
+	ticks(&s, 2, 5);
+	ticks(&s, 2, 50);
+	CHECK(s.tasks[TASK_A].latency_min == 5);
+	CHECK(s.tasks[TASK_A].latency_max == 50);
+
+	// Échéance manquée : deux libérations sans sched_run, une seule exécution
+	sched_clear(&s);
+	s.tasks[TASK_A].countdown = 0;
+	sched_tick(&s);
+	sched_tick(&s);
+	sched_tick(&s);
+	CHECK(s.tasks[TASK_A].misses == 1);
+	sched_run(&s);
+	CHECK(s.tasks[TASK_A].runs == 1);
+	CHECK(sched_run(&s) == 0);
+
+	// Dépassements isolés : comptés, sans mode dégradé
+	sched_clear(&s);
+	cost[TASK_B] = 150;
+	ticks(&s, 4 * (SCHED_OVERRUN_LIMIT - 1), 0);
+	cost[TASK_B] = 20;
+	ticks(&s, 4, 0);
+	CHECK(s.tasks[TASK_B].overruns == SCHED_OVERRUN_LIMIT - 1);
+	CHECK(s.tasks[TASK_B].consecutive == 0);
+	CHECK(!s.degraded && fallbacks == 0);
+
+	// SCHED_OVERRUN_LIMIT dépassements consécutifs : mode dégradé, repli
+	// appelé une fois avec la tâche en cause
+	cost[TASK_B] = 150;
+	ticks(&s, 4 * SCHED_OVERRUN_LIMIT, 0);
+	CHECK(s.degraded);
+	CHECK(fallbacks == 1 && fallback_task == TASK_B);
+
+	// Mode dégradé : b n'est plus libérée, a continue
+	uint32_t runs_a = s.tasks[TASK_A].runs;
+	uint32_t runs_b = s.tasks[TASK_B].runs;
+
+	ticks(&s, 16, 0);
+	CHECK(s.tasks[TASK_B].runs == runs_b);
+	CHECK(s.tasks[TASK_A].runs == runs_a + 8);
+	CHECK(fallbacks == 1);
+
+	// Une essentielle en dépassement ne rappelle pas le repli
+	cost[TASK_A] = 150;
+	ticks(&s, 2 * SCHED_OVERRUN_LIMIT, 0);
+	CHECK(s.tasks[TASK_A].overruns == SCHED_OVERRUN_LIMIT);
+	CHECK(fallbacks == 1);
+
+	// Sortie : statistiques remises à zéro, b de nouveau libérée
+	cost[TASK_A] = 10;
+	cost[TASK_B] = 20;
+	sched_clear(&s);
+	CHECK(!s.degraded);
+	CHECK(s.tasks[TASK_B].overruns == 0 && s.tasks[TASK_B].runs == 0);
+	CHECK(s.tasks[TASK_B].latency_min == UINT32_MAX);
+	ticks(&s, 8, 0);
+	CHECK(s.tasks[TASK_B].runs == 2);
+
+	// Horloge qui reboucle pendant une tâche : durée modulo 2^32
+	sched_clear(&s);
+	now = UINT32_MAX - 4;
+	ticks(&s, 4, 0);
+	CHECK(s.tasks[TASK_A].exec_max == 10);
+	CHECK(s.tasks[TASK_B].exec_max == 20);
+	CHECK(s.tasks[TASK_A].overruns == 0 && s.tasks[TASK_B].overruns == 0);
+
+	return TEST_END();
+}
+
+/* End of functions ----------------------------------------------------------*/
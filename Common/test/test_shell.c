@@ -0,0 +1,171 @@
+/**
+ ******************************************************************************
+ * @file	test_shell.c
+ * @brief	Test hôte du shell : table triée, recherche, découpage, saisie
+ ******************************************************************************
+ */
+
+#include <string.h>
+
+#include "shell.h"
+#include "test.h"
+
+/* Variables -----------------------------------------------------------------*/
+extern const shell_func_t __shell_cmd_start[];
+extern const shell_func_t __shell_cmd_end[];
+
+// Transport simulé : entrée rejouée, sortie accumulée
+static char out[4096];
+static size_t out_len = 0;
+static const char * in = "";
+static size_t in_n = 0;
+static int in_lost = 0;
+
+// Dernier appel de commande
+static int calls = 0;
+static int last_argc = 0;
+static char last_argv[8][40];
+
+static uint8_t frame[64];
+static size_t frame_len = 0;
+/* End of variables ----------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static int io_write(char * s, uint16_t size) {
+	if (out_len + size >= sizeof(out)) out_len = 0;
+	memcpy(&out[out_len], s, size);
+	out_len += size;
+	out[out_len] = '\0';
+	return size;
+}
+
+static int io_read(char * ch) {
+	if (in_lost) {
+		in_lost = 0;
+		return -1;
+	}
+	if (in_n == 0) return 0;
+	*ch = *in++;
+	in_n--;
+	return 1;
+}
+
+static const shell_io_t io = { io_write, io_read };
+
+static int record(int argc, char ** argv) {
+	calls++;
+	last_argc = argc;
+	for (int i = 0 ; i < argc && i < 8 ; i++) {
+		strncpy(last_argv[i], argv[i], sizeof(last_argv[i]) - 1);
+	}
+	return 7;
+}
+
+// Trame : tout jusqu'au 0x00 de fin (le premier 0x00 l'ouvre)
+static int frame_rx(uint8_t ch) {
+	frame[frame_len++] = ch;
+	return !(ch == 0 && frame_len > 1);
+}
+
+SHELL_CMD(a, record, "une lettre");
+SHELL_CMD(set, record, "nom exact, prefixe de setx");
+SHELL_CMD(setx, record, "nom prolongeant set");
+SHELL_CMD(status, record, "prefixe st unique");
+
+static void feed_n(const char * s, size_t n) {
+	in = s;
+	in_n = n;
+	shell_process();
+}
+
+static void feed(const char * s) {
+	feed_n(s, strlen(s));
+}
+
+int main() {
+	const shell_func_t * f;
+	size_t n = __shell_cmd_end - __shell_cmd_start;
+	char line[64];
+
+	// Table : commandes des quatre SHELL_CMD + help, triée par nom
+	CHECK(n == 5);
+	for (size_t i = 1 ; i < n ; i++) {
+		CHECK(strcmp(__shell_cmd_start[i - 1].cmd, __shell_cmd_start[i].cmd) < 0);
+	}
+
+	// Recherche : nom exact, préfixe unique, préfixe ambigu, inconnu
+	f = shell_find("a", 1);
+	CHECK(f != NULL && !strcmp(f->cmd, "a"));
+	f = shell_find("set", 3);
+	CHECK(f != NULL && !strcmp(f->cmd, "set"));
+	f = shell_find("setx", 4);
+	CHECK(f != NULL && !strcmp(f->cmd, "setx"));
+	f = shell_find("st", 2);
+	CHECK(f != NULL && !strcmp(f->cmd, "status"));
+	f = shell_find("he", 2);
+	CHECK(f != NULL && !strcmp(f->cmd, "help"));
+	CHECK(shell_find("s", 1) == NULL);
+	CHECK(shell_find("se", 2) == NULL);
+	CHECK(shell_find("x", 1) == NULL);
+	CHECK(shell_find("statusx", 7) == NULL);
+	CHECK(shell_find("", 0) == NULL);
+
+	// Longueur explicite : le reste de la ligne est ignoré
+	f = shell_find("set 12", 3);
+	CHECK(f != NULL && !strcmp(f->cmd, "set"));
+
+	// Exécution : découpage en arguments, valeur de retour
+	strcpy(line, "set 12 -3.5");
+	CHECK(shell_exec(line) == 7);
+	CHECK(last_argc == 3);
+	CHECK(!strcmp(last_argv[0], "set"));
+	CHECK(!strcmp(last_argv[1], "12"));
+	CHECK(!strcmp(last_argv[2], "-3.5"));
+
+	strcpy(line, "a 1 2 3 4 5 6 7 8 9");
+	shell_exec(line);
+	CHECK(last_argc == 8);
+
+	shell_init(&io, "> ");
+	CHECK(strstr(out, "Shell") != NULL);
+
+	out_len = 0;
+	strcpy(line, "nope 1");
+	CHECK(shell_exec(line) == -1);
+	CHECK(strstr(out, "nope 1: command not found") != NULL);
+
+	// Saisie caractère par caractère, écho et effacement
+	calls = 0;
+	out_len = 0;
+	feed("sex\bt 5\r");
+	CHECK(calls == 1);
+	CHECK(!strcmp(last_argv[0], "set") && !strcmp(last_argv[1], "5"));
+	CHECK(strstr(out, "\b \b") != NULL);
+
+	// Ligne trop longue : tronquée au tampon, sans débordement
+	calls = 0;
+	feed("a 0123456789012345678901234567890123456789012345678901234567890\r");
+	CHECK(calls == 1);
+	CHECK(strlen(last_argv[1]) < 40);
+
+	// Flux perdu par le transport : la ligne en cours est abandonnée
+	calls = 0;
+	feed("set 1");
+	in_lost = 1;
+	feed("a\r");
+	CHECK(calls == 1 && !strcmp(last_argv[0], "a") && last_argc == 1);
+
+	// Trame binaire : de 0x00 à 0x00, puis retour au mode ligne
+	static const char mixed[] = { 0, 3, 'x', 'y', 0, 'a', ' ', 'z', '\r' };
+
+	shell_set_frame_handler(frame_rx);
+	calls = 0;
+	feed_n(mixed, sizeof(mixed));
+	CHECK(frame_len == 5 && frame[1] == 3 && frame[4] == 0);
+	CHECK(calls == 1 && !strcmp(last_argv[1], "z"));
+
+	return TEST_END();
+}
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,107 @@
+/**
+ ******************************************************************************
+ * @file	test_sysid.c
+ * @brief	Test hôte de l'identification : SBPA sur un moteur RL / J-f simulé
+ ******************************************************************************
+ *
+ * Même essai que la commande "id" du TP : SBPA autour d'un biais depuis
+ * l'arrêt, sur la profondeur du scope à 3 voies, échantillons quantifiés
+ * comme sur la cible (courant en 1/16 de LSB ADC, CCR1, pas codeur). Les
+ * paramètres identifiés sont comparés à ceux du modèle.
+ */
+
+#include "sysid.h"
+#include "scope.h"
+#include "motor_sim.h"
+#include "test.h"
+
+/* Macros --------------------------------------------------------------------*/
+#define DEPTH (SCOPE_BUFFER_SIZE / 3)
+#define BLOCK 16					// SYSID_BLOCK
+#define HOLD 4						// SYSID_HOLD
+#define BIAS 0.3
+#define AMPLITUDE 0.1
+/* End of macros -------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static int identify(motor_sim_t * m, sysid_result_t * res) {
+	sysid_t id;
+	prbs_t prbs;
+
+	sysid_init(&id, MOTOR_SIM_TE, MOTOR_SIM_VBUS, MOTOR_SIM_TICKS_PER_REV, BLOCK);
+	prbs_init(&prbs, HOLD);
+
+	for (int k = 0 ; k < DEPTH ; k++) {
+		motor_sim_sample_t s = motor_sim_step(m, BIAS + AMPLITUDE * prbs_next(&prbs));
+
+		// Conversions de sysid_fit (main.c)
+		float u = 2.0f * (float)s.duty / (float)(MOTOR_SIM_ARR + 1) - 1.0f;
+		float i = (float)s.adc * (float)MOTOR_SIM_A_PER_LSB;
+
+		sysid_add(&id, u, i, s.delta);
+	}
+
+	return sysid_solve(&id, res);
+}
+
+int main() {
+	motor_sim_t m;
+	sysid_result_t res;
+
+	// SBPA : bits tenus HOLD périodes, longueur maximale (2^14 bits à +1,
+	// 2^14 - 1 à -1), puis répétition à l'identique
+	prbs_t prbs;
+	int8_t first[64];
+	int sum = 0;
+	int held = 1;
+	int8_t prev = 0;
+
+	prbs_init(&prbs, HOLD);
+	for (int k = 0 ; k < 32767 * HOLD ; k++) {
+		int8_t b = prbs_next(&prbs);
+
+		if (k < 64) first[k] = b;
+		if (k % HOLD != 0 && b != prev) held = 0;
+		prev = b;
+		sum += b;
+	}
+	CHECK(held);
+	CHECK(sum == HOLD);
+	for (int k = 0 ; k < 64 ; k++) {
+		if (prbs_next(&prbs) != first[k]) held = 0;
+	}
+	CHECK(held);
+
+	// Moteur libre : les cinq paramètres
+	motor_sim_init(&m);
+	CHECK(identify(&m, &res) == 0);
+	CHECK_NEAR(res.r, MOTOR_SIM_R, 0.02 * MOTOR_SIM_R);
+	CHECK_NEAR(res.l, MOTOR_SIM_L, 0.02 * MOTOR_SIM_L);
+	CHECK_NEAR(res.ke, MOTOR_SIM_KE, 0.02 * MOTOR_SIM_KE);
+	CHECK_NEAR(res.j, MOTOR_SIM_J, 0.05 * MOTOR_SIM_J);
+	CHECK_NEAR(res.f, MOTOR_SIM_F, 0.05 * MOTOR_SIM_F);
+	CHECK(res.r2_elec > 0.999f);
+	CHECK(res.r2_mech > 0.99f);
+
+	// Rotor bloqué : modèle R-L seul, ni ke ni partie mécanique
+	motor_sim_init(&m);
+	m.locked = 1;
+	CHECK(identify(&m, &res) == 0);
+	CHECK_NEAR(res.r, MOTOR_SIM_R, 0.02 * MOTOR_SIM_R);
+	CHECK_NEAR(res.l, MOTOR_SIM_L, 0.02 * MOTOR_SIM_L);
+	CHECK(res.ke == 0.0f);
+	CHECK(res.j == 0.0f && res.f == 0.0f);
+	CHECK(res.r2_elec > 0.999f);
+
+	// Sans excitation (u constant) : pas de modèle électrique
+	sysid_t id;
+
+	sysid_init(&id, MOTOR_SIM_TE, MOTOR_SIM_VBUS, MOTOR_SIM_TICKS_PER_REV, BLOCK);
+	for (int k = 0 ; k < DEPTH ; k++) sysid_add(&id, 0.0f, 0.0f, 0);
+	CHECK(sysid_solve(&id, &res) != 0);
+
+	return TEST_END();
+}
+
+/* End of functions ----------------------------------------------------------*/
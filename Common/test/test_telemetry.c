@@ -0,0 +1,156 @@
+/**
+ ******************************************************************************
+ * @file	test_telemetry.c
+ * @brief	Test hôte de la télémétrie : file SPSC, décimation, trames, pertes
+ ******************************************************************************
+ *
+ * Le producteur (ISR simulée) et le consommateur s'alternent dans un ordre
+ * pseudo-aléatoire. Chaque enregistrement publié porte son numéro : les
+ * trames reçues doivent les contenir tous, dans l'ordre et sans trou ; les
+ * enregistrements refusés file pleine sont seulement comptés.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "telemetry.h"
+#include "test.h"
+
+/* Variables -----------------------------------------------------------------*/
+static telem_t telem;
+
+// Liaison simulée : trames décodées, refus à la demande
+static int link_busy = 0;
+static uint32_t rx_next = 0;		// prochain numéro attendu
+static uint32_t rx_records = 0;
+static uint32_t rx_gaps = 0;		// numéros sautés
+static int rx_errors = 0;
+static uint16_t rx_max_len = 0;
+/* End of variables ----------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static uint32_t get_u32(const uint8_t * p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Voie c de l'enregistrement numéro t
+static int32_t channel_value(uint32_t t, uint8_t c) {
+	return (int32_t)(t * 8 + c) * ((c & 1) ? -1 : 1);
+}
+
+static int link_send(const uint8_t * data, uint16_t len) {
+	if (link_busy) return -1;
+	if (len > rx_max_len) rx_max_len = len;
+
+	uint8_t mask = data[0];
+	uint8_t n = data[1];
+	uint16_t pos = 2;
+
+	for (uint8_t i = 0 ; i < n ; i++) {
+		uint32_t t = get_u32(&data[pos]);
+
+		pos += 4;
+		if (t < rx_next) rx_errors++;		// doublon ou désordre
+		rx_gaps += t - rx_next;
+		rx_next = t + 1;
+		for (uint8_t c = 0 ; c < TELEM_CHANNELS ; c++) {
+			if (mask & (1 << c)) {
+				if ((int32_t)get_u32(&data[pos]) != channel_value(t, c)) rx_errors++;
+				pos += 4;
+			}
+		}
+		rx_records++;
+	}
+	if (pos != len) rx_errors++;
+
+	return 0;
+}
+
+// Appel du producteur ; numérote l'enregistrement s'il est retenu
+static int produce(uint32_t * seq) {
+	telem_record_t * r = telem_begin(&telem);
+
+	if (r == NULL) return 0;
+	r->t = (*seq)++;
+	for (uint8_t c = 0 ; c < TELEM_CHANNELS ; c++) r->ch[c] = channel_value(r->t, c);
+	telem_commit(&telem);
+	return 1;
+}
+
+int main() {
+	telem_stats_t s;
+	uint32_t seq = 0;
+	int taken = 0;
+
+	// Arrêtée à l'initialisation
+	telem_init(&telem);
+	CHECK(telem_begin(&telem) == NULL);
+
+	// Décimation : un enregistrement tous les n appels
+	telem_config(&telem, 0xFF, 5);
+	for (int k = 0 ; k < 100 ; k++) taken += produce(&seq);
+	CHECK(taken == 20);
+	CHECK(telem_process(&telem, link_send, 256) == 20);
+	CHECK(rx_records == 20 && rx_gaps == 0 && rx_errors == 0);
+	CHECK(rx_max_len <= 256);
+
+	// File pleine : pertes comptées, le reste émis dans l'ordre
+	telem_config(&telem, 0x0F, 1);
+	for (int k = 0 ; k < TELEM_RING_SIZE + 10 ; k++) produce(&seq);
+	telem_get_stats(&telem, &s);
+	CHECK(s.dropped == 10 && s.peak == TELEM_RING_SIZE);
+	telem_process(&telem, link_send, 256);
+	CHECK(rx_records == 20 + TELEM_RING_SIZE && rx_errors == 0);
+
+	// Liaison occupée : rien n'est perdu côté émission, reprise au suivant
+	produce(&seq);
+	link_busy = 1;
+	CHECK(telem_process(&telem, link_send, 256) == 0);
+	telem_get_stats(&telem, &s);
+	CHECK(s.busy == 1);
+	link_busy = 0;
+	CHECK(telem_process(&telem, link_send, 256) == 1);
+	CHECK(rx_errors == 0);
+
+	// Trame trop petite pour un enregistrement
+	produce(&seq);
+	CHECK(telem_process(&telem, link_send, 2 + 4 + 4 * 4 - 1) == 0);
+	CHECK(telem_process(&telem, link_send, 2 + 4 + 4 * 4) == 1);
+
+	// Reconfiguration : la file est vidée, nouveau format seulement
+	produce(&seq);
+	produce(&seq);
+	telem_config(&telem, 0x81, 1);
+	rx_next = seq;
+	produce(&seq);
+	CHECK(telem_process(&telem, link_send, 256) == 1 && rx_errors == 0);
+
+	// Entrelacement aléatoire producteur / consommateur, au-delà de 2^16
+	// enregistrements (débordement des index de la file)
+	srand(1);
+	rx_records = 0;
+	rx_gaps = 0;
+	rx_next = seq;
+	telem_init(&telem);
+	telem_config(&telem, 0x55, 2);
+	uint32_t first = seq;
+	for (int k = 0 ; k < 400000 ; k++) {
+		int r = rand() % 100;
+
+		if (r < 70) produce(&seq);
+		else if (r < 72) link_busy = !link_busy;
+		else telem_process(&telem, link_send, 16 + (rand() % 240));
+	}
+	link_busy = 0;
+	telem_process(&telem, link_send, 256);
+	telem_get_stats(&telem, &s);
+	CHECK(rx_errors == 0);
+	CHECK(s.produced == seq - first);
+	CHECK(rx_records == s.produced && rx_gaps == 0);
+	CHECK(s.sent == rx_records && s.produced > 65536 && s.dropped > 0);
+
+	return TEST_END();
+}
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,165 @@
+/**
+ ******************************************************************************
+ * @file	test_traj.c
+ * @brief	Test hôte du générateur de trajectoire : cibles exactes et limites
+ ******************************************************************************
+ *
+ * Chaque mouvement est joué tick par tick. Vérifications : position et
+ * vitesse finales exactes, recalage de fin inférieur à un pas, vitesse,
+ * accélération et jerk effectifs sous les limites (à l'arrondi Q32.32 près).
+ */
+
+#include <stdlib.h>
+
+#include "traj.h"
+#include "test.h"
+
+/* Macros --------------------------------------------------------------------*/
+#define Q(x) ((int64_t)((x) * (double)TRAJ_ONE))
+#define F(x) ((double)(x) / (double)TRAJ_ONE)
+
+// Tolérance sur les limites : arrondis Q32.32 et durées arrondies par excès
+#define LIMIT_TOL 1.0001
+/* End of macros -------------------------------------------------------------*/
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct{
+	uint32_t ticks;
+	double vmax;				// maxima observés
+	double amax;
+	double jmax;
+	double snap;				// recalage de fin de mouvement (pas)
+} run_t;
+/* End of types --------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+// Joue la file jusqu'au repos, au plus max_ticks
+static run_t run(traj_t * t, uint32_t max_ticks) {
+	run_t r = {0};
+	int64_t acc_prev = t->acc;
+
+	while (!traj_idle(t) && r.ticks < max_ticks) {
+		int64_t pos_prev = t->pos;
+		int64_t vel_prev = t->vel;
+		uint8_t busy_prev = t->busy;
+		uint8_t tail_prev = t->tail;
+
+		traj_tick(t);
+		r.ticks++;
+
+		if (t->tail != tail_prev && busy_prev) {
+			// Fin de mouvement : écart entre l'intégration et la cible recalée
+			int64_t pos_int = pos_prev + (vel_prev + vel_prev + acc_prev) / 2;
+			double s = fabs(F(t->pos - pos_int));
+			if (s > r.snap) r.snap = s;
+		}
+
+		double v = fabs(F(t->vel));
+		double a = fabs(F(t->acc));
+		double j = fabs(F(t->acc - acc_prev));
+
+		if (v > r.vmax) r.vmax = v;
+		if (a > r.amax) r.amax = a;
+		if (j > r.jmax) r.jmax = j;
+		acc_prev = t->acc;
+	}
+
+	return r;
+}
+
+static int within(const run_t * r, float vmax, float amax, float jmax) {
+	return r->vmax <= vmax * LIMIT_TOL && r->amax <= amax * LIMIT_TOL
+			&& (jmax <= 0.0f || r->jmax <= jmax * LIMIT_TOL);
+}
+
+int main() {
+	static traj_t t;
+	run_t r;
+
+	// S-curve, longue course : les trois limites sont atteintes
+	traj_init(&t, 0, 0);
+	traj_set_limits(&t, 50.0f, 0.5f, 0.01f);
+	CHECK(traj_move_pos(&t, Q(100000)) == 0);
+	r = run(&t, 100000);
+	CHECK(t.pos == Q(100000) && t.vel == 0 && t.acc == 0);
+	CHECK(within(&r, 50.0f, 0.5f, 0.01f));
+	CHECK(r.vmax > 49.0 && r.amax > 0.49);
+	CHECK(r.snap < 1.0);
+
+	// Retour, position négative, puis course courte sans croisière
+	CHECK(traj_move_pos(&t, Q(-2500)) == 0);
+	CHECK(traj_move_pos(&t, Q(-2490)) == 0);
+	r = run(&t, 100000);
+	CHECK(t.pos == Q(-2490) && t.vel == 0);
+	CHECK(within(&r, 50.0f, 0.5f, 0.01f));
+	CHECK(r.snap < 1.0);
+
+	// Trapèze (jmax = 0)
+	traj_set_limits(&t, 20.0f, 0.2f, 0.0f);
+	CHECK(traj_move_pos(&t, Q(7777.5)) == 0);
+	r = run(&t, 100000);
+	CHECK(t.pos == Q(7777.5) && t.vel == 0);
+	CHECK(within(&r, 20.0f, 0.2f, 0.0f));
+	CHECK(r.snap < 1.0);
+
+	// Cibles aléatoires : exactitude et limites sur tous les profils
+	srand(1);
+	int ok = 1;
+	traj_init(&t, 0, 0);
+	for (int k = 0 ; k < 300 && ok ; k++) {
+		float vmax = 0.5f + (rand() % 1000) / 10.0f;
+		float amax = 0.001f + (rand() % 1000) / 1000.0f;
+		float jmax = (k % 3 == 0) ? 0.0f : amax * (0.001f + (rand() % 1000) / 1000.0f);
+		int64_t target = ((int64_t)(rand() % 2000001) - 1000000) * (TRAJ_ONE / 16);
+
+		traj_set_limits(&t, vmax, amax, jmax);
+		ok = traj_move_pos(&t, target) == 0;
+		r = run(&t, 10000000);
+		ok = ok && traj_idle(&t) && t.pos == target && t.vel == 0;
+		ok = ok && within(&r, vmax, amax, jmax) && r.snap < 1.0;
+	}
+	CHECK(ok);
+
+	// Mouvement en vitesse : vitesse finale exacte, maintenue
+	traj_init(&t, 0, 0);
+	traj_set_limits(&t, 30.0f, 0.3f, 0.005f);
+	CHECK(traj_move_vel(&t, Q(12.25)) == 0);
+	r = run(&t, 100000);
+	CHECK(t.vel == Q(12.25) && t.acc == 0);
+	CHECK(within(&r, 30.0f, 0.3f, 0.005f));
+	int64_t p = t.pos;
+	traj_tick(&t);
+	CHECK(t.pos - p == Q(12.25) && t.vel == Q(12.25));
+
+	// Bornée à vmax ; point à point refusé tant que la vitesse n'est pas nulle
+	CHECK(traj_move_vel(&t, Q(100)) == 0);
+	run(&t, 100000);
+	CHECK(t.vel == Q(30));
+	CHECK(traj_move_pos(&t, Q(0)) == -1);
+	CHECK(traj_move_vel(&t, 0) == 0);
+	run(&t, 100000);
+	CHECK(t.vel == 0);
+	p = t.pos;
+	CHECK(traj_move_pos(&t, p + Q(1000)) == 0);
+	run(&t, 100000);
+	CHECK(t.pos == p + Q(1000));
+
+	// File pleine, limites invalides
+	traj_init(&t, 0, 0);
+	for (int k = 0 ; k < TRAJ_QUEUE_SIZE ; k++) CHECK(traj_move_pos(&t, Q(k + 1)) == 0);
+	CHECK(traj_move_pos(&t, Q(100)) == -1);
+	traj_set_limits(&t, 0.0f, 0.1f, 0.0f);
+	traj_init(&t, 0, 0);
+	CHECK(traj_move_pos(&t, Q(1)) == -1);
+
+	// Au-delà de 2^31 pas : position modulo 2^32 pas, sans perte de pas
+	traj_init(&t, Q(2147483000.0), Q(100));
+	for (int k = 0 ; k < 20 ; k++) traj_tick(&t);
+	CHECK((uint32_t)(t.pos >> 32) == (uint32_t)(2147483000u + 2000u));
+	CHECK(t.vel == Q(100));
+
+	return TEST_END();
+}
+
+/* End of functions ----------------------------------------------------------*/
@@ -0,0 +1,131 @@
+/**
+ ******************************************************************************
+ * @file	test_velocity.c
+ * @brief	Test hôte de la vitesse M/T : précision, retard de datation, arrêt
+ ******************************************************************************
+ *
+ * Codeur simulé à vitesse constante : un front capturé tous les EDGE pas,
+ * le premier après chaque tick est daté avec un retard (latence de l'ISR de
+ * capture). L'horloge de datation part juste sous 2^32 pour traverser son
+ * débordement.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "velocity.h"
+#include "test.h"
+
+/* Macros --------------------------------------------------------------------*/
+#define CLK 170000000.0			// DWT
+#define TPR 4000				// ENC_TICKS_PER_REV
+#define EDGE 4					// x4 : un front TI1 montant tous les 4 pas
+#define FS 1000.0				// SPEED_LOOP_HZ
+#define TIMEOUT_S 0.1f
+#define CLK0 0xFFF00000u		// débordement de l'horloge après ~6 ms
+/* End of macros -------------------------------------------------------------*/
+
+/* Functions -----------------------------------------------------------------*/
+
+static uint32_t clk(double t) {
+	return CLK0 + (uint32_t)(uint64_t)llround(t * CLK);
+}
+
+/**
+ * Simulation de n ticks à vitesse w, retard de capture tiré dans [0, lat_max]
+ * cycles. Renvoie l'erreur relative maximale de w_raw une fois la première
+ * fenêtre fermée.
+ */
+static double run(vel_t * vel, double w, int n, uint32_t lat_max) {
+	double k_edge = 2.0 * M_PI * EDGE / (w * TPR);	// s entre deux fronts (signé)
+	double err = 0.0;
+	int windows = 0;
+
+	for (int k = 1 ; k <= n ; k++) {
+		double t_tick = k / FS;
+
+		vel_update(vel, clk(t_tick));
+		if (vel->w_raw != 0.0f && windows++ > 0) {
+			double e = fabs(vel->w_raw - w) / fabs(w);
+			if (e > err) err = e;
+		}
+
+		// Premier front après le tick
+		long m = (long)floor(t_tick / fabs(k_edge)) + 1;
+		double t_edge = m * fabs(k_edge);
+
+		if (t_edge < (k + 1) / FS) {
+			uint32_t lat = lat_max ? (uint32_t)rand() % (lat_max + 1) : 0;
+			int32_t cnt = (int32_t)(w > 0 ? m * EDGE : -m * EDGE);
+
+			vel_capture(vel, (uint32_t)cnt, clk(t_edge) + lat);
+		}
+	}
+
+	return err;
+}
+
+int main() {
+	vel_t vel;
+	double err;
+
+	srand(1);
+
+	// Vitesse constante, datation exacte : erreur de la seule quantification
+	// de l'horloge (1 cycle sur ~170000) et du calcul en float
+	vel_init(&vel, TPR, EDGE, (uint32_t)CLK, TIMEOUT_S);
+	err = run(&vel, 100.0, 50, 0);
+	CHECK(err < 1e-5);
+
+	vel_init(&vel, TPR, EDGE, (uint32_t)CLK, TIMEOUT_S);
+	err = run(&vel, -250.0, 50, 0);
+	CHECK(err < 1e-5 && vel.w_raw < 0.0f);
+
+	// Retard de capture : erreur relative ~ retard / dT (dT ~ 1 ms)
+	// Priorité propre : au plus une centaine de cycles, < 0,1 %
+	vel_init(&vel, TPR, EDGE, (uint32_t)CLK, TIMEOUT_S);
+	err = run(&vel, 500.0, 200, 100);
+	CHECK(err < 100.0 / (CLK / FS) + 1e-5);
+
+	// Capture retardée par une ISR ADC ou TIM6 complète (~5000 cycles) :
+	// erreur de plusieurs pour cent, d'où la priorité de la capture
+	vel_init(&vel, TPR, EDGE, (uint32_t)CLK, TIMEOUT_S);
+	err = run(&vel, 500.0, 200, 5000);
+	CHECK(err > 0.01);
+
+	// Basse vitesse : un front toutes les ~12,6 ms, la mesure reste exacte
+	// aux fronts et la borne edge_ticks / dt ne la dégrade pas
+	vel_init(&vel, TPR, EDGE, (uint32_t)CLK, TIMEOUT_S);
+	err = run(&vel, 0.5, 300, 0);
+	CHECK(err < 1e-4);
+
+	// Arrêt : borne décroissante sans front, puis 0 après le timeout
+	float w_last = vel.w_raw;
+	uint32_t t = clk(301 / FS);
+	for (int k = 0 ; k < 50 ; k++) vel_update(&vel, t + k * (uint32_t)(CLK / FS));
+	CHECK(fabsf(vel.w_raw) < fabsf(w_last));
+	for (int k = 50 ; k < 120 ; k++) vel_update(&vel, t + k * (uint32_t)(CLK / FS));
+	CHECK(vel.w_raw == 0.0f && vel.edge_valid == 0);
+
+	// Reprise : le premier front ne ferme aucune fenêtre
+	vel_capture(&vel, 1000, t + 121 * (uint32_t)(CLK / FS));
+	vel_update(&vel, t + 122 * (uint32_t)(CLK / FS));
+	CHECK(vel.w_raw == 0.0f && vel.edge_valid == 1);
+
+	// Passe-bas : échelon, constante de temps 1 / (2.pi.fc)
+	vel_init(&vel, TPR, EDGE, (uint32_t)CLK, TIMEOUT_S);
+	vel_set_filter(&vel, 10.0f, FS);
+	run(&vel, 100.0, 16, 0);
+	CHECK(vel.w > 0.0f && vel.w < 0.7f * 100.0f);
+	vel_init(&vel, TPR, EDGE, (uint32_t)CLK, TIMEOUT_S);
+	vel_set_filter(&vel, 10.0f, FS);
+	run(&vel, 100.0, 300, 0);
+	CHECK_NEAR(vel.w, 100.0, 0.1);
+
+	vel_set_filter(&vel, 0.0f, FS);
+	CHECK(vel.alpha == 1.0f);
+
+	return TEST_END();
+}
+
+/* End of functions ----------------------------------------------------------*/
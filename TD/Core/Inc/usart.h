@@ -34,7 +34,8 @@ extern "C" {
 extern UART_HandleTypeDef hlpuart1;
 
 /* USER CODE BEGIN Private defines */
-
+extern DMA_HandleTypeDef hdma_lpuart1_tx;
+extern DMA_HandleTypeDef hdma_lpuart1_rx;
 /* USER CODE END Private defines */
 
 void MX_LPUART1_UART_Init(void);
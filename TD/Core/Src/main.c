@@ -18,7 +18,6 @@
   */
 /* USER CODE END Header */
 /* Includes ------------------------------------------------------------------*/
-#include "myShell.h"
 #include "main.h"
 #include "usart.h"
 #include "tim.h"
@@ -27,6 +26,11 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include <stdio.h>
+#include <string.h>
+#include "shell.h"
+#include "shell_uart.h"
+#include "fmt.h"
+#include "encoder.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -40,13 +44,17 @@
 
 /* Private macro -------------------------------------------------------------*/
 /* USER CODE BEGIN PM */
-
+#define ENC_TICKS_PER_REV 40
+#define ENC_FREQ_ECH 10
 /* USER CODE END PM */
 
 /* Private variables ---------------------------------------------------------*/
 
 /* USER CODE BEGIN PV */
-
+volatile uint32_t uart_isr_cycles_max = 0;
+enc_t encoder;
+volatile int32_t enc_ticks = 0;
+volatile uint8_t enc_ready = 0;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -68,6 +76,24 @@ int fonction(int argc, char ** argv) {
 
 	return 0;
 }
+
+int isr_stats(int argc, char ** argv) {
+	uint32_t max = uart_isr_cycles_max;
+
+	printf("uart isr max = %lu cycles (%lu us)\r\n",
+			(unsigned long)max, (unsigned long)(max / (SystemCoreClock / 1000000)));
+	printf("rx overflow = %lu\r\n", (unsigned long)uart_rx_overflow());
+	printf("rx errors = %lu\r\n", (unsigned long)uart_rx_errors());
+
+	if (argc == 2 && !strcmp(argv[1], "reset")) {
+		uart_isr_cycles_max = 0;
+	}
+
+	return 0;
+}
+
+SHELL_CMD(fonction, fonction, "Fonction exemple");
+SHELL_CMD(isr, isr_stats, "Temps max ISR uart (isr reset : remise a zero)");
 /* USER CODE END 0 */
 
 /**
@@ -103,20 +129,41 @@ int main(void)
   MX_TIM2_Init();
   MX_TIM6_Init();
   /* USER CODE BEGIN 2 */
-  shell_init();
-  shell_add("fonction", fonction, "Fonction exemple");
+  uart_init(&hlpuart1);
+  shell_init(&shell_uart_io, "@Nucleo-G431 >> ");
+
+  // Compteur de cycles DWT pour la mesure des temps d'ISR
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
   HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_1);
 
-  //HAL_TIM_Base_Start_IT(&htim6);
   //HAL_TIM_Encoder_Start(&htim2, TIM_CHANNEL_ALL);
+  // Compteur codeur libre, jamais remis a zero
+  enc_init(&encoder, TIM2->CNT, ENC_TICKS_PER_REV);
+  //HAL_TIM_Base_Start_IT(&htim6);
   /* USER CODE END 2 */
 
   /* Infinite loop */
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-
+    shell_process();
+
+    // Affichage hors ISR : un échantillon manqué n'est pas rattrapé
+    if (enc_ready)
+    {
+      int32_t ticks = enc_ticks;
+
+      enc_ready = 0;
+      // ticks*ENC_FREQ_ECH/ENC_TICKS_PER_REV tr/s, en centiemes
+      fmt_puts("ticks = ");
+      fmt_put_i32(ticks);
+      fmt_puts("\t speed = ");
+      fmt_put_fixed(ticks * ENC_FREQ_ECH * 100 / ENC_TICKS_PER_REV, 2);
+      fmt_puts(" tr/s\r\n");
+    }
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -179,18 +226,21 @@ void SystemClock_Config(void)
 
 /* USER CODE BEGIN 4 */
 
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart){
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size){
 	if(huart->Instance == LPUART1){
-		shell_char_received();
-		HAL_UART_Receive_IT(&hlpuart1, (uint8_t*)&c, 1);
+		uint32_t start = DWT->CYCCNT;
+
+		uart_rx_event(huart, Size);
+
+		uint32_t cycles = DWT->CYCCNT - start;
+		if(cycles > uart_isr_cycles_max) uart_isr_cycles_max = cycles;
 	}
 }
 
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim){
 	if(htim->Instance == TIM6){
-		int16_t ticks = TIM2->CNT;
-		TIM2->CNT = 0;
-		printf("ticks = %d\t speed = %0.2f tr/s\r\n",ticks,(float)(ticks*10)/40);
+		enc_ticks = enc_update(&encoder, TIM2->CNT);
+		enc_ready = 1;
 	}
 }
 
@@ -59,7 +59,8 @@
 extern UART_HandleTypeDef hlpuart1;
 extern TIM_HandleTypeDef htim6;
 /* USER CODE BEGIN EV */
-
+extern DMA_HandleTypeDef hdma_lpuart1_tx;
+extern DMA_HandleTypeDef hdma_lpuart1_rx;
 /* USER CODE END EV */
 
 /******************************************************************************/
@@ -230,5 +231,21 @@ void LPUART1_IRQHandler(void)
 
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief This function handles DMA1 channel2 global interrupt (LPUART1_TX).
+  */
+void DMA1_Channel2_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_lpuart1_tx);
+}
+
+/**
+  * @brief This function handles DMA1 channel3 global interrupt (LPUART1_RX).
+  */
+void DMA1_Channel3_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_lpuart1_rx);
+}
+
 /* USER CODE END 1 */
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,113 @@
+/**
+ ******************************************************************************
+ * @file	CONTROL.h
+ * @brief	Boucles de vitesse et de courant en cascade
+ ******************************************************************************
+ *
+ * Boucle de courant exécutée dans l'interruption de fin de séquence ADC
+ * (déclenchée par TIM1 au centre de la période MLI). La sortie u est la
+ * tension moyenne normalisée du pont en H : u = 2.alpha - 1, alpha = CCR1 / (ARR + 1), CCR2 = ARR - CCR1.
+ * Les CCR sont préchargés (OCxPE) : pris en compte à l'événement de mise à
+ * jour suivant, jamais au milieu d'une période.
+ *
+ * Boucle de vitesse exécutée sur l'interruption TIM6 (SPEED_LOOP_HZ, tim.h),
+ * à partir de la vitesse estimée par la méthode M/T (velocity.h). Sa sortie est la consigne
+ * de la boucle de courant (SPEED_OUT_CURRENT) ou directement u (SPEED_OUT_DUTY).
+ * Consigne, gains, anticipation et rampe sont des float modifiables à la
+ * volée depuis le shell, sans masquer les interruptions.
+ *
+ * En mode trajectoire (traj.h), la rampe est remplacée par le générateur :
+ * w_ref = v_traj + POS_KP.(p_traj - p_codeur), anticipation kff.w_ref +
+ * kacc.a_traj. Les mouvements sont mis en file par le shell (m) ou le
+ * protocole binaire (PROTOCOL_MOVE).
+ *
+ * Réglage automatique (autotune.h) : un relais remplace le PI de la boucle
+ * choisie, dans son ISR et à sa période. Les gains calculés sont écrits par
+ * cette même ISR en fin d'essai, jamais pendant une itération du PI.
+ *
+ * Identification (sysid.h) : boucles arrêtées, u = biais + amplitude.SBPA à
+ * chaque séquence ADC. La capture et l'ajustement sont faits par l'appelant.
+ */
+
+#ifndef INC_CONTROL_H_
+#define INC_CONTROL_H_
+
+#include <stdint.h>
+
+#include "encoder.h"
+
+// Fréquence de la boucle : f_MLI / CURRENT_LOOP_DIV
+#define CURRENT_LOOP_DIV 1
+
+// Mesure : i = (adc / CURRENT_ADC_SCALE - CURRENT_OFFSET) * CURRENT_A_PER_LSB,
+// voie ADC_RED filtrée, sur 16 bits (adc.h, ADC_FE_BITS)
+#define CURRENT_ADC_SCALE 16.0f
+#define CURRENT_OFFSET 2048.0f
+#define CURRENT_A_PER_LSB (3.3f / 4096.0f / 0.05f)	// capteur 50 mV/A
+
+#define CURRENT_KP 0.05f		// 1/A
+#define CURRENT_KI 100.0f		// 1/(A.s)
+#define CURRENT_I_MAX 5.0f		// A, borne de la consigne
+#define CURRENT_TRIP 8.0f		// A, coupure par le chien de garde ADC
+#define DUTY_MAX 0.95f			// |u| max
+#define VBUS 24.0f				// V, tension du bus du pont en H (u = 1)
+
+#define ENC_TICKS_PER_REV 4000
+
+#define SPEED_OUT_CURRENT 0		// sortie : consigne de courant (A)
+#define SPEED_OUT_DUTY 1		// sortie : tension normalisée u
+#define SPEED_OUT SPEED_OUT_CURRENT
+
+#define SPEED_KP 0.05f			// A.s/rad (u.s/rad en SPEED_OUT_DUTY)
+#define SPEED_KI 0.5f			// A/rad
+#define SPEED_KFF 0.0f			// anticipation, sortie par rad/s de consigne
+#define SPEED_RAMP 200.0f		// rad/s²
+#define SPEED_MAX 300.0f		// rad/s, borne de la consigne
+
+#define POS_KP 20.0f			// (rad/s)/rad, correction de position en trajectoire
+#define TRAJ_VMAX 200.0f		// rad/s
+#define TRAJ_AMAX 2000.0f		// rad/s²
+#define TRAJ_JMAX 50000.0f		// rad/s³, 0 : trapèze
+
+#define CONTROL_LOOP_NONE 0
+#define CONTROL_LOOP_CURRENT 1
+#define CONTROL_LOOP_SPEED 2
+
+#define AT_CURRENT_D 0.2f		// relais sur u
+#define AT_CURRENT_EPS 0.05f	// A
+#define AT_SPEED_D 0.5f			// relais sur la sortie de la boucle de vitesse (A ou u)
+#define AT_SPEED_EPS 0.5f		// rad/s
+#define AT_TIMEOUT_S 5.0f
+#define AT_RULE AT_RULE_TL
+
+#define SYSID_HOLD 4			// périodes MLI par bit de la SBPA
+
+typedef struct{
+	uint32_t iterations;
+	uint32_t cycles_last;
+	uint32_t cycles_max;
+	uint32_t cycles_budget;		// cycles CPU entre deux itérations
+} control_stats_t;
+
+void control_init(const enc_t * enc);
+void control_adc_isr(const uint32_t * adc);
+void control_write_duty(float u);
+void control_current_start(float i_ref);
+void control_stop();
+void control_speed_isr(float w);
+void control_speed_start(float w_ref);
+int control_speed_set_output(uint8_t out);
+uint8_t control_speed_enabled();
+float control_speed_get();
+int control_move_pos(int64_t ticks);
+int control_move_vel(int32_t ticks_per_s);
+int control_traj_set_limits(float vmax, float amax, float jmax);
+uint8_t control_current_enabled();
+uint8_t control_active();
+float control_current_get();
+void control_get_stats(control_stats_t * stats);
+int control_autotune_start(uint8_t loop, float d, float eps, float ref);
+uint8_t control_autotune_state();
+int control_sysid_start(float bias, float amplitude, uint16_t hold);
+
+#endif /* INC_CONTROL_H_ */
@@ -0,0 +1,62 @@
+/**
+ ******************************************************************************
+ * @file	MOTOR.h
+ * @brief	Machine d'états de la puissance (pilote de grille et pont en H)
+ ******************************************************************************
+ *
+ * DISABLED -> RESETTING -> ARMED -> RUNNING, et FAULT depuis tout état :
+ *  - DISABLED : ISO_RESET bas, MLI arrêtée, boucles arrêtées ;
+ *  - RESETTING : impulsion ISO_RESET, durée MOTOR_RESET_US comptée par TIM7
+ *    en mode une impulsion (tim.h), sans attente active ;
+ *  - ARMED : pilote sorti de reset, MLI active à tension nulle (u = 0) ;
+ *  - RUNNING : une commande a été appliquée (rapport cyclique ou boucle) ;
+ *  - FAULT : puissance coupée par une protection, seul MOTOR_EV_REARM en sort.
+ *
+ * Les événements (shell, bouton B1, protocole, TIM7) sont traités
+ * immédiatement par motor_post(), BASEPRI au niveau de la boucle de courant
+ * (main.h), depuis la boucle principale comme depuis une ISR. La
+ * désactivation coupe les sorties (MOE) avant tout le reste.
+ *
+ * La protection, plus prioritaire, n'est jamais masquée : motor_trip() coupe
+ * MOE et laisse une demande que le motor_post() suivant (tâche de contrôle
+ * au plus tard) transforme en passage à FAULT.
+ */
+
+#ifndef INC_MOTOR_H_
+#define INC_MOTOR_H_
+
+#include <stdint.h>
+
+// États
+#define MOTOR_DISABLED 0
+#define MOTOR_RESETTING 1
+#define MOTOR_ARMED 2
+#define MOTOR_RUNNING 3
+#define MOTOR_FAULT 4
+
+// Événements
+#define MOTOR_EV_ENABLE 0
+#define MOTOR_EV_DISABLE 1
+#define MOTOR_EV_TOGGLE 2			// bouton B1
+#define MOTOR_EV_RESET_DONE 3		// fin de l'impulsion TIM7
+#define MOTOR_EV_RUN 4				// première commande appliquée
+#define MOTOR_EV_FAULT 5
+#define MOTOR_EV_REARM 6
+
+typedef struct{
+	uint32_t enable_last;		// cycles, demande -> MLI active (impulsion comprise)
+	uint32_t enable_max;
+	uint32_t disable_last;		// cycles, demande -> sorties coupées
+	uint32_t disable_max;
+	uint32_t ignored;			// événements sans effet dans l'état courant
+} motor_stats_t;
+
+extern volatile uint8_t motor_state;	// lecture seule hors de MOTOR.c
+
+void motor_init();
+int motor_post(uint8_t ev);
+void motor_trip();
+const char * motor_state_name(uint8_t state);
+void motor_get_stats(motor_stats_t * stats);
+
+#endif /* INC_MOTOR_H_ */
@@ -0,0 +1,57 @@
+/**
+ ******************************************************************************
+ * @file	PROTOCOL.h
+ * @brief	Protocole binaire (COBS + CRC-16) multiplexé avec le shell
+ ******************************************************************************
+ *
+ * Trame sur la liaison : 0x00 | COBS(type, seq, données, crc16) | 0x00
+ * Le premier 0x00 fait basculer le shell en réception binaire, le second
+ * termine la trame. Le shell ASCII reste utilisable entre deux trames.
+ * Codage et CRC : cobs.h. Valeurs multi-octets en little-endian.
+ */
+
+#ifndef INC_PROTOCOL_H_
+#define INC_PROTOCOL_H_
+
+#include <stdint.h>
+
+#include "cobs.h"
+
+#define PROTOCOL_DATA_MAX_SIZE 64
+#define PROTOCOL_VAR_LIST_MAX_SIZE 16
+#define PROTOCOL_HANDLER_LIST_MAX_SIZE 8
+#define PROTOCOL_STREAM_MAX_VARS 8
+// Trame codée au pire (COBS + délimiteurs) pour len octets de données
+#define PROTOCOL_FRAME_MAX_SIZE(len) COBS_FRAME_MAX_SIZE(len)
+
+// Types de messages (hôte -> carte). La réponse porte le type | PROTOCOL_REPLY.
+#define PROTOCOL_SET_DUTY 0x01		// uint16 : CCR1 (0..ARR)
+#define PROTOCOL_SET_SPEED 0x02		// int16 : consigne en centièmes de %
+#define PROTOCOL_READ_VARS 0x03		// n x uint8 : identifiants des variables
+#define PROTOCOL_STREAM 0x04		// uint16 période (ms, 0 = arrêt) + n x uint8 identifiants
+#define PROTOCOL_MOVE 0x05			// uint8 type (0 : position, 1 : vitesse) + int32 (pas ou pas/s)
+#define PROTOCOL_TELEM 0x06			// uint8 masque des voies + uint16 décimation (0 = arrêt)
+#define PROTOCOL_SCOPE 0x07			// uint8 : 0 arrêt, 1 armement, 2 déclenchement manuel
+#define PROTOCOL_MOTOR 0x08			// uint8 : 0 désactivation, 1 activation, 2 réarmement après défaut
+#define PROTOCOL_REPLY 0x80
+
+// Statut renvoyé dans les acquittements
+#define PROTOCOL_OK 0
+#define PROTOCOL_ERR_TYPE 1
+#define PROTOCOL_ERR_ARG 2
+
+typedef struct{
+	uint32_t frames;
+	uint32_t crc_errors;
+	uint32_t cobs_errors;
+	uint32_t overruns;
+} protocol_stats_t;
+
+int protocol_rx_byte(uint8_t ch);
+void protocol_process();
+int protocol_send(uint8_t type, uint8_t seq, const uint8_t * data, uint16_t len);
+int protocol_add_var(uint8_t id, volatile void * ptr, uint8_t size);
+int protocol_add_handler(uint8_t type, int (* pfunc)(const uint8_t * data, uint16_t len));
+void protocol_get_stats(protocol_stats_t * stats);
+
+#endif /* INC_PROTOCOL_H_ */
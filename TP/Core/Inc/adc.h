@@ -34,12 +34,48 @@ extern "C" {
 extern ADC_HandleTypeDef hadc1;
 
 /* USER CODE BEGIN Private defines */
+// Sur-échantillonnage matériel au démarrage : 2^ADC_OVS_LOG2 conversions par
+// voie à chaque déclenchement, somme décalée de ADC_OVS_SHIFT bits. Résultat
+// sur 12 + LOG2 - SHIFT bits (12 à 16), modifiable par adc_set_oversampling()
+#define ADC_OVS_LOG2 3
+#define ADC_OVS_SHIFT 3
+#define ADC_OVS_MAX_LOG2 8
+
+#define ADC_CHANNELS 2
+// Une conversion : 24,5 + 12,5 cycles ADC, horloge ADC = HCLK / 4
+#define ADC_CONV_CPU_CYCLES (37 * 4)
+
+// Mesures publiées sur 16 bits quel que soit le sur-échantillonnage
+// (1/16 de LSB 12 bits) : résultat ADC << adc_norm_shift()
+#define ADC_FE_BITS 16
+#define ADC_FE_MID 32768			// courant nul après étalonnage
+
+// Étalonnage des voies : y = ADC_FE_MID + ((x - offset) * gain) >> ADC_CAL_GAIN_SHIFT,
+// x mesure 16 bits, gain Q14 (produit sur 32 bits pour gain < 2)
+#define ADC_CAL_GAIN_SHIFT 14
+#define ADC_CAL_GAIN_ONE (1 << ADC_CAL_GAIN_SHIFT)
+#define ADC_CAL_SAMPLES 4096		// séquences moyennées (~0,25 s à 16,6 kHz)
+#define ADC_CAL_OFFSET_MAX 6554		// écart toléré à ADC_FE_MID (10 %)
+#define ADC_CAL_TIMEOUT_MS 1000
+#define ADC_CAL_SETTLE_MS 200		// établissement du courant (étalonnage du gain)
+
+typedef struct{
+	int32_t offset[ADC_CHANNELS];	// mesure 16 bits à courant nul
+	int32_t gain[ADC_CHANNELS];		// Q14
+} adc_cal_t;
 
 /* USER CODE END Private defines */
 
 void MX_ADC1_Init(void);
 
 /* USER CODE BEGIN Prototypes */
+void adc_start(uint32_t * buf, uint32_t len);
+int adc_set_oversampling(uint8_t ratio_log2, uint8_t shift);
+void adc_get_oversampling(uint8_t * ratio_log2, uint8_t * shift);
+uint8_t adc_norm_shift();
+int adc_self_calibration();
+void adc_awd_set(int32_t low, int32_t high);
+void adc_awd_enable(uint8_t enable);
 
 /* USER CODE END Prototypes */
 
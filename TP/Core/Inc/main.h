@@ -42,6 +42,19 @@ extern "C" {
 
 /* Exported constants --------------------------------------------------------*/
 /* USER CODE BEGIN EC */
+// Priorités NVIC (préemption, groupe 4 : 0 la plus urgente), identiques au .ioc
+#define IRQ_PRIO_PROTECTION 0		// ADC1_2 : chien de garde analogique
+#define IRQ_PRIO_CAPTURE 1			// TIM2 : datation des fronts codeur (vitesse M/T)
+#define IRQ_PRIO_CURRENT 2			// DMA1_Channel1 : fin de séquence ADC, boucle de courant
+#define IRQ_PRIO_SPEED 3			// TIM6 : boucle de vitesse et exécutif
+#define IRQ_PRIO_MOTOR 4			// TIM7 : fin du reset du pilote de grille
+#define IRQ_PRIO_COMM 5				// LPUART1 et ses DMA
+#define IRQ_PRIO_BUTTON 6			// EXTI
+#define IRQ_PRIO_TICK 15			// SysTick (TICK_INT_PRIORITY)
+
+// Section critique par BASEPRI : masque les priorités >= prio, les niveaux plus
+// urgents restent actifs. __set_BASEPRI_MAX ne baisse jamais le masque courant.
+#define IRQ_BASEPRI(prio) ((prio) << (8U - __NVIC_PRIO_BITS))
 
 /* USER CODE END EC */
 
@@ -54,6 +67,7 @@ extern "C" {
 void Error_Handler(void);
 
 /* USER CODE BEGIN EFP */
+void latency_probe(void);
 
 /* USER CODE END EFP */
 
@@ -34,14 +34,27 @@ extern "C" {
 extern TIM_HandleTypeDef htim1;
 extern TIM_HandleTypeDef htim2;
 extern TIM_HandleTypeDef htim6;
+extern TIM_HandleTypeDef htim7;
 
 /* USER CODE BEGIN Private defines */
+// Déclenchement ADC par TIM1 TRGO2 (OC4REF), en ticks TIM1 avant le sommet du
+// comptage centré. En montée, CNT va de 0 à ARR - 1 : avec CCR4 = ARR, OC4REF
+// (PWM2) ne passe jamais actif et TRGO2 ne part pas. 1 au minimum : la rafale
+// de conversions démarre un tick (PSC + 1 cycles) avant le centre de la période
+#define ADC_TRIG_ADVANCE 1
+
+// Fréquence de TIM6 (boucle de vitesse), diviseur entier de 10 kHz
+#define SPEED_LOOP_HZ 1000
+
+// Impulsion ISO_RESET du pilote de grille (one-shot TIM7, horloge 1 MHz), µs
+#define MOTOR_RESET_US 100
 
 /* USER CODE END Private defines */
 
 void MX_TIM1_Init(void);
 void MX_TIM2_Init(void);
 void MX_TIM6_Init(void);
+void MX_TIM7_Init(void);
 
 void HAL_TIM_MspPostInit(TIM_HandleTypeDef *htim);
 
@@ -0,0 +1,605 @@
+/**
+ ******************************************************************************
+ * @file	CONTROL.c
+ * @brief	Boucles de vitesse et de courant en cascade
+ ******************************************************************************
+ */
+
+#include "CONTROL.h"
+
+#include <string.h>
+#include <math.h>
+
+#include "main.h"
+#include "tim.h"
+#include "pi.h"
+#include "traj.h"
+#include "autotune.h"
+#include "sysid.h"
+#include "fmt.h"
+#include "shell.h"
+
+static pi_t pi_current;
+static volatile float i_ref = 0.0f;
+static volatile float i_meas = 0.0f;
+static volatile uint8_t current_enabled = 0;
+static uint8_t loop_count = 0;
+
+static pi_t pi_speed;
+static volatile float w_target = 0.0f;		// consigne demandée
+static volatile float w_ref = 0.0f;			// consigne après rampe
+static volatile float w_meas = 0.0f;
+static volatile float speed_kff = SPEED_KFF;
+static volatile float speed_ramp = SPEED_RAMP;
+static volatile uint8_t speed_enabled = 0;
+static uint8_t speed_out = SPEED_OUT;
+static volatile float speed_kacc = 0.0f;
+
+// Trajectoire : unités du générateur (Q32.32 pas, pas/tick...) -> rad
+#define RAD_PER_TICK (2.0f * (float)M_PI / ENC_TICKS_PER_REV)
+#define TRAJ_POS_SCALE (RAD_PER_TICK / 4294967296.0f)
+#define TRAJ_VEL_SCALE (TRAJ_POS_SCALE * SPEED_LOOP_HZ)
+#define TRAJ_ACC_SCALE (TRAJ_VEL_SCALE * SPEED_LOOP_HZ)
+
+static const enc_t * encoder = NULL;
+static traj_t traj;
+static volatile uint8_t traj_enabled = 0;
+static volatile float pos_kp = POS_KP;
+static volatile float a_ref = 0.0f;
+static uint32_t traj_cycles_last = 0;
+static uint32_t traj_cycles_max = 0;
+
+static at_t autotune;
+static volatile uint8_t at_loop = CONTROL_LOOP_NONE;	// boucle en cours de réglage
+static uint8_t at_last = CONTROL_LOOP_NONE;		// dernière boucle réglée
+
+static prbs_t prbs;
+static volatile uint8_t sysid_enabled = 0;
+static float sysid_bias = 0.0f;
+static float sysid_amplitude = 0.0f;
+
+static control_stats_t stats = {0};
+
+static float autotune_step(pi_t * pi, float y);
+
+void control_init(const enc_t * enc) {
+	// TIM1 en comptage centré : une période MLI = 2.(ARR+1) ticks
+	uint32_t pwm_cycles = (TIM1->PSC + 1) * 2 * (TIM1->ARR + 1);
+
+	stats.cycles_budget = pwm_cycles * CURRENT_LOOP_DIV;
+	pi_init(&pi_current, CURRENT_KP, CURRENT_KI,
+			(float)stats.cycles_budget / (float)SystemCoreClock, -DUTY_MAX, DUTY_MAX);
+	pi_init(&pi_speed, SPEED_KP, SPEED_KI, 1.0f / SPEED_LOOP_HZ, -CURRENT_I_MAX, CURRENT_I_MAX);
+	control_speed_set_output(speed_out);
+
+	encoder = enc;
+	control_traj_set_limits(TRAJ_VMAX, TRAJ_AMAX, TRAJ_JMAX);
+}
+
+// Tension normalisée [-1, 1] -> rapports cycliques complémentaires des deux bras
+void control_write_duty(float u) {
+	uint32_t arr = TIM1->ARR;
+	int32_t cmd = (int32_t)((u + 1.0f) * 0.5f * (float)(arr + 1));
+
+	if (cmd < 0) cmd = 0;
+	else if (cmd > (int32_t)arr) cmd = arr;
+
+	TIM1->CCR1 = cmd;
+	TIM1->CCR2 = arr - cmd;
+}
+
+// Fin de séquence ADC (contexte ISR), adc[0] : voie ADC_RED filtrée (16 bits)
+void control_adc_isr(const uint32_t * adc) {
+	uint32_t start = DWT->CYCCNT;
+	uint8_t tuning = (at_loop == CONTROL_LOOP_CURRENT);
+
+	i_meas = ((float)adc[0] * (1.0f / CURRENT_ADC_SCALE) - CURRENT_OFFSET) * CURRENT_A_PER_LSB;
+
+	if (sysid_enabled) {
+		control_write_duty(sysid_bias + sysid_amplitude * prbs_next(&prbs));
+		return;
+	}
+
+	if (!current_enabled && !tuning) return;
+	if (++loop_count < CURRENT_LOOP_DIV) return;
+	loop_count = 0;
+
+	if (tuning) {
+		control_write_duty(autotune_step(&pi_current, i_meas));
+		return;
+	}
+
+	control_write_duty(pi_update(&pi_current, i_ref - i_meas, 0.0f));
+
+	uint32_t cycles = DWT->CYCCNT - start;
+	stats.cycles_last = cycles;
+	if (cycles > stats.cycles_max) stats.cycles_max = cycles;
+	stats.iterations++;
+}
+
+// Une période d'essai au relais (ISR de la boucle réglée). En fin d'essai,
+// les gains sont écrits ici, entre deux itérations du PI de cette boucle.
+static float autotune_step(pi_t * pi, float y) {
+	float u = at_update(&autotune, y);
+
+	if (autotune.state != AT_RUNNING) {
+		float kp;
+		float ki;
+
+		if (at_gains(&autotune, AT_RULE, &kp, &ki) == 0) {
+			pi->kp = kp;
+			pi->ki = ki;
+		}
+		at_loop = CONTROL_LOOP_NONE;
+	}
+
+	return u;
+}
+
+// Démarrage sans à-coup : l'intégrale reprend le rapport cyclique courant
+static void current_enable(float ref) {
+	if (ref > CURRENT_I_MAX) ref = CURRENT_I_MAX;
+	else if (ref < -CURRENT_I_MAX) ref = -CURRENT_I_MAX;
+	i_ref = ref;
+
+	if (!current_enabled) {
+		float u = 2.0f * (float)TIM1->CCR1 / (float)(TIM1->ARR + 1) - 1.0f;
+
+		pi_reset(&pi_current, u);
+		loop_count = 0;
+		current_enabled = 1;
+	}
+}
+
+// Consigne de courant manuelle : la boucle de vitesse est arrêtée
+void control_current_start(float ref) {
+	sysid_enabled = 0;
+	at_loop = CONTROL_LOOP_NONE;
+	speed_enabled = 0;
+	current_enable(ref);
+}
+
+// Arrêt des deux boucles : retour en boucle ouverte, le dernier rapport
+// cyclique est conservé
+void control_stop() {
+	sysid_enabled = 0;
+	at_loop = CONTROL_LOOP_NONE;
+	traj_enabled = 0;
+	speed_enabled = 0;
+	current_enabled = 0;
+}
+
+// Interruption TIM6 : w = vitesse mesurée (rad/s)
+void control_speed_isr(float w) {
+	w_meas = w;
+
+	if (at_loop == CONTROL_LOOP_SPEED) {
+		float out = autotune_step(&pi_speed, w);
+
+		if (speed_out == SPEED_OUT_CURRENT) i_ref = out;
+		else control_write_duty(out);
+		return;
+	}
+
+	if (!speed_enabled) return;
+
+	float ref;
+	float acc = 0.0f;
+
+	if (traj_enabled) {
+		// Générateur de trajectoire + correction de position
+		enc_snapshot_t snap;
+		uint32_t start = DWT->CYCCNT;
+
+		traj_tick(&traj);
+
+		uint32_t cycles = DWT->CYCCNT - start;
+		traj_cycles_last = cycles;
+		if (cycles > traj_cycles_max) traj_cycles_max = cycles;
+
+		enc_get(encoder, &snap);
+
+		// Erreur de position : parties entières modulo 2^32 (snap.position * 2^32
+		// déborde au-delà de 2^31 pas), puis fraction de la consigne
+		int32_t e_int = (int32_t)((uint32_t)(traj.pos >> 32) - (uint32_t)snap.position);
+		float e = (float)e_int + (float)(uint32_t)traj.pos * (1.0f / 4294967296.0f);
+
+		acc = (float)traj.acc * TRAJ_ACC_SCALE;
+		ref = (float)traj.vel * TRAJ_VEL_SCALE + pos_kp * e * RAD_PER_TICK;
+	}
+	else {
+		// Rampe de consigne
+		float step = speed_ramp / SPEED_LOOP_HZ;
+		float target = w_target;
+
+		ref = w_ref;
+		if (target > ref + step) ref += step;
+		else if (target < ref - step) ref -= step;
+		else ref = target;
+	}
+	w_ref = ref;
+	a_ref = acc;
+
+	float out = pi_update(&pi_speed, ref - w_meas, speed_kff * ref + speed_kacc * acc);
+
+	if (speed_out == SPEED_OUT_CURRENT) {
+		i_ref = out;
+	}
+	else {
+		control_write_duty(out);
+	}
+}
+
+// Démarrage sans à-coup : rampe depuis la vitesse mesurée, intégrale
+// préchargée avec la commande en cours
+void control_speed_start(float w) {
+	// Consigne manuelle : la rampe repart de la consigne courante
+	sysid_enabled = 0;
+	at_loop = CONTROL_LOOP_NONE;
+	traj_enabled = 0;
+
+	if (w > SPEED_MAX) w = SPEED_MAX;
+	else if (w < -SPEED_MAX) w = -SPEED_MAX;
+	w_target = w;
+
+	if (!speed_enabled) {
+		float out;
+
+		if (speed_out == SPEED_OUT_CURRENT) {
+			out = current_enabled ? i_ref : 0.0f;
+			current_enable(out);
+		}
+		else {
+			current_enabled = 0;
+			out = 2.0f * (float)TIM1->CCR1 / (float)(TIM1->ARR + 1) - 1.0f;
+		}
+
+		w_ref = w_meas;
+		pi_reset(&pi_speed, out - speed_kff * w_ref);
+		speed_enabled = 1;
+	}
+}
+
+// Choix de la sortie de la boucle de vitesse, uniquement à l'arrêt
+int control_speed_set_output(uint8_t out) {
+	if (speed_enabled) return -1;
+
+	speed_out = out;
+	if (out == SPEED_OUT_CURRENT) {
+		pi_speed.out_min = -CURRENT_I_MAX;
+		pi_speed.out_max = CURRENT_I_MAX;
+	}
+	else {
+		pi_speed.out_min = -DUTY_MAX;
+		pi_speed.out_max = DUTY_MAX;
+	}
+
+	return 0;
+}
+
+uint8_t control_speed_enabled() {
+	return speed_enabled;
+}
+
+float control_speed_get() {
+	return w_meas;
+}
+
+// Passage en mode trajectoire depuis la position et la consigne courantes
+static void traj_enable() {
+	if (!traj_enabled) {
+		enc_snapshot_t snap;
+		float w0 = speed_enabled ? w_ref : 0.0f;
+
+		enc_get(encoder, &snap);
+		// Position de la consigne modulo 2^32 pas, comme l'erreur calculée en ISR
+		traj_init(&traj, (int64_t)((uint64_t)snap.position << 32), (int64_t)(w0 / TRAJ_VEL_SCALE));
+		control_speed_start(w0);
+		traj_enabled = 1;
+	}
+}
+
+// Mouvement point à point vers une position absolue (pas codeur)
+int control_move_pos(int64_t ticks) {
+	traj_enable();
+	return traj_move_pos(&traj, ticks * TRAJ_ONE);
+}
+
+// Changement de vitesse (pas/s), maintenue jusqu'au mouvement suivant
+int control_move_vel(int32_t ticks_per_s) {
+	traj_enable();
+	return traj_move_vel(&traj, ((int64_t)ticks_per_s << 32) / SPEED_LOOP_HZ);
+}
+
+// Limites en rad/s, rad/s², rad/s³ (jmax = 0 : trapèze), pour les mouvements suivants
+int control_traj_set_limits(float vmax, float amax, float jmax) {
+	const float k = 1.0f / RAD_PER_TICK;
+	const float f = SPEED_LOOP_HZ;
+
+	if (vmax <= 0.0f || amax <= 0.0f || jmax < 0.0f) return -1;
+
+	traj_set_limits(&traj, vmax * k / f, amax * k / (f * f), jmax * k / (f * f * f));
+	return 0;
+}
+
+uint8_t control_current_enabled() {
+	return current_enabled;
+}
+
+// Une boucle, un essai ou une identification commande le pont
+uint8_t control_active() {
+	return current_enabled || speed_enabled || traj_enabled || sysid_enabled
+			|| at_loop != CONTROL_LOOP_NONE;
+}
+
+float control_current_get() {
+	return i_meas;
+}
+
+// Essai au relais sur la boucle de courant (d sur u, eps en A, ref en A)
+// ou de vitesse (d en sortie de la boucle, eps et ref en rad/s). Les
+// boucles sont arrêtées ; la boucle de courant tourne à 0 A pendant
+// l'essai de la boucle de vitesse si celle-ci la commande.
+int control_autotune_start(uint8_t loop, float d, float eps, float ref) {
+	float te;
+
+	if (d <= 0.0f || eps < 0.0f) return -1;
+
+	control_stop();
+
+	if (loop == CONTROL_LOOP_CURRENT) {
+		if (d > DUTY_MAX) d = DUTY_MAX;
+		te = pi_current.te;
+		loop_count = 0;
+	}
+	else if (loop == CONTROL_LOOP_SPEED) {
+		if (d > pi_speed.out_max) d = pi_speed.out_max;
+		te = pi_speed.te;
+		if (speed_out == SPEED_OUT_CURRENT) current_enable(0.0f);
+	}
+	else {
+		return -1;
+	}
+
+	at_start(&autotune, ref, 0.0f, d, eps, te, AT_TIMEOUT_S);
+	at_last = loop;
+	at_loop = loop;
+
+	return 0;
+}
+
+uint8_t control_autotune_state() {
+	return autotune.state;
+}
+
+// Excitation d'identification : u = bias + amplitude.SBPA, bit tenu hold
+// périodes MLI, jusqu'à control_stop()
+int control_sysid_start(float bias, float amplitude, uint16_t hold) {
+	if (amplitude <= 0.0f || fabsf(bias) + amplitude > DUTY_MAX) return -1;
+
+	control_stop();
+
+	prbs_init(&prbs, hold);
+	sysid_bias = bias;
+	sysid_amplitude = amplitude;
+	sysid_enabled = 1;
+
+	return 0;
+}
+
+void control_get_stats(control_stats_t * s) {
+	uint32_t basepri = __get_BASEPRI();
+	__set_BASEPRI_MAX(IRQ_BASEPRI(IRQ_PRIO_CURRENT));
+	*s = stats;
+	__set_BASEPRI(basepri);
+}
+
+// c : état de la boucle, c <A> : consigne de courant, c off : boucle ouverte
+static int sh_current(int argc, char ** argv) {
+	control_stats_t s;
+
+	if (argc == 2) {
+		int32_t ma;
+
+		if (!strcmp(argv[1], "off")) {
+			control_stop();
+		}
+		else if (fmt_parse_fixed(argv[1], 3, &ma) == 0) {
+			control_current_start(ma / 1000.0f);
+		}
+		else {
+			fmt_puts("consigne invalide\r\n");
+			return -1;
+		}
+	}
+
+	control_get_stats(&s);
+	fmt_puts(current_enabled ? "boucle courant : on\r\n" : "boucle courant : off\r\n");
+	fmt_puts("i ref = ");
+	fmt_put_fixed((int32_t)(i_ref * 1000.0f), 3);
+	fmt_puts(" A\r\ni = ");
+	fmt_put_fixed((int32_t)(i_meas * 1000.0f), 3);
+	fmt_puts(" A\r\nu = ");
+	fmt_put_fixed((int32_t)(pi_current.out * 1000.0f), 3);
+	fmt_puts("\r\niterations = ");
+	fmt_put_u32(s.iterations);
+	fmt_puts("\r\ncycles = ");
+	fmt_put_u32(s.cycles_last);
+	fmt_puts(" (max ");
+	fmt_put_u32(s.cycles_max);
+	fmt_puts(" / ");
+	fmt_put_u32(s.cycles_budget);
+	fmt_puts(")\r\n");
+
+	return 0;
+}
+
+// Gains et paramètres : écriture directe d'un float, lue par l'ISR suivante
+static int speed_param(const char * name, const char * value) {
+	int32_t v;
+
+	if (fmt_parse_fixed(value, 4, &v) != 0) return -1;
+
+	if (!strcmp(name, "kp")) pi_speed.kp = v / 10000.0f;
+	else if (!strcmp(name, "ki")) pi_speed.ki = v / 10000.0f;
+	else if (!strcmp(name, "kff")) speed_kff = v / 10000.0f;
+	else if (!strcmp(name, "ramp")) speed_ramp = v / 10000.0f;
+	else if (!strcmp(name, "kacc")) speed_kacc = v / 10000.0f;
+	else if (!strcmp(name, "kpos")) pos_kp = v / 10000.0f;
+	else return -1;
+
+	return 0;
+}
+
+static void put_param(const char * name, float v, uint8_t decimals) {
+	int32_t scale = 1;
+
+	for (uint8_t i = 0 ; i < decimals ; i++) scale *= 10;
+
+	fmt_puts(name);
+	fmt_puts(" = ");
+	fmt_put_fixed((int32_t)(v * scale), decimals);
+	fmt_puts("\r\n");
+}
+
+// w : état, w <rad/s> : consigne, w off, w out i|u, w kp|ki|kff|ramp <valeur>
+static int sh_speed(int argc, char ** argv) {
+	int32_t v;
+
+	if (argc == 2) {
+		if (!strcmp(argv[1], "off")) {
+			control_stop();
+			control_write_duty(0.0f);
+		}
+		else if (fmt_parse_fixed(argv[1], 2, &v) == 0) {
+			control_speed_start(v / 100.0f);
+		}
+		else {
+			fmt_puts("consigne invalide\r\n");
+			return -1;
+		}
+	}
+	else if (argc == 3 && !strcmp(argv[1], "out")) {
+		uint8_t out = (argv[2][0] == 'u') ? SPEED_OUT_DUTY : SPEED_OUT_CURRENT;
+
+		if (control_speed_set_output(out) != 0) {
+			fmt_puts("boucle de vitesse active (w off)\r\n");
+			return -1;
+		}
+	}
+	else if (argc == 3) {
+		if (speed_param(argv[1], argv[2]) != 0) {
+			fmt_puts("parametre invalide\r\n");
+			return -1;
+		}
+	}
+
+	fmt_puts(speed_enabled ? "boucle vitesse : on" : "boucle vitesse : off");
+	fmt_puts(speed_out == SPEED_OUT_CURRENT ? " (sortie i)\r\n" : " (sortie u)\r\n");
+	put_param("w cible", w_target, 2);
+	put_param("w ref", w_ref, 2);
+	put_param("w", w_meas, 2);
+	put_param("sortie", pi_speed.out, 3);
+	put_param("kp", pi_speed.kp, 4);
+	put_param("ki", pi_speed.ki, 4);
+	put_param("kff", speed_kff, 4);
+	put_param("ramp", speed_ramp, 1);
+	put_param("kacc", speed_kacc, 4);
+	put_param("kpos", pos_kp, 4);
+
+	return 0;
+}
+
+// m : état, m p <rad> : position absolue, m v <rad/s> : vitesse,
+// m lim <rad/s> <rad/s²> <rad/s³> : limites (jerk 0 : trapèze)
+static int sh_move(int argc, char ** argv) {
+	int32_t v[3];
+	int r = 0;
+
+	if (argc == 3 && (!strcmp(argv[1], "p") || !strcmp(argv[1], "v"))) {
+		if (fmt_parse_fixed(argv[2], 3, &v[0]) != 0) {
+			fmt_puts("consigne invalide\r\n");
+			return -1;
+		}
+		float ticks = (float)v[0] / (1000.0f * RAD_PER_TICK);
+		r = (argv[1][0] == 'p') ? control_move_pos((int64_t)ticks) : control_move_vel((int32_t)ticks);
+	}
+	else if (argc == 5 && !strcmp(argv[1], "lim")) {
+		for (int i = 0 ; i < 3 ; i++) {
+			if (fmt_parse_fixed(argv[2 + i], 1, &v[i]) != 0) {
+				fmt_puts("limite invalide\r\n");
+				return -1;
+			}
+		}
+		r = control_traj_set_limits(v[0] / 10.0f, v[1] / 10.0f, v[2] / 10.0f);
+	}
+
+	if (r != 0) {
+		fmt_puts("refuse (file pleine, limites, ou mouvement en vitesse non arrete)\r\n");
+	}
+
+	fmt_puts(traj_enabled ? "trajectoire : on, file " : "trajectoire : off, file ");
+	fmt_put_u32((uint8_t)(traj.head - traj.tail));
+	fmt_puts("/");
+	fmt_put_u32(TRAJ_QUEUE_SIZE);
+	fmt_puts("\r\n");
+	put_param("p traj", (float)(traj.pos >> 32) * RAD_PER_TICK, 2);
+	put_param("v traj", (float)traj.vel * TRAJ_VEL_SCALE, 2);
+	put_param("a traj", a_ref, 1);
+	fmt_puts("cycles/tick = ");
+	fmt_put_u32(traj_cycles_last);
+	fmt_puts(" (max ");
+	fmt_put_u32(traj_cycles_max);
+	fmt_puts(")\r\n");
+
+	return r;
+}
+
+// at : résultat, at i|w [d [eps [ref]]] : essai sur la boucle de courant ou de vitesse
+static int sh_autotune(int argc, char ** argv) {
+	static const char * states[] = {"aucun", "en cours", "termine", "echec"};
+
+	if (argc >= 2 && argc <= 5 && (!strcmp(argv[1], "i") || !strcmp(argv[1], "w"))) {
+		uint8_t loop = (argv[1][0] == 'i') ? CONTROL_LOOP_CURRENT : CONTROL_LOOP_SPEED;
+		float p[3] = {AT_CURRENT_D, AT_CURRENT_EPS, 0.0f};
+		int32_t v;
+
+		if (loop == CONTROL_LOOP_SPEED) {
+			p[0] = AT_SPEED_D;
+			p[1] = AT_SPEED_EPS;
+		}
+		for (int i = 2 ; i < argc ; i++) {
+			if (fmt_parse_fixed(argv[i], 3, &v) != 0) {
+				fmt_puts("parametre invalide\r\n");
+				return -1;
+			}
+			p[i - 2] = v / 1000.0f;
+		}
+		if (control_autotune_start(loop, p[0], p[1], p[2]) != 0) {
+			fmt_puts("parametre invalide\r\n");
+			return -1;
+		}
+	}
+	else if (argc == 2 && !strcmp(argv[1], "stop")) {
+		control_stop();
+		control_write_duty(0.0f);
+	}
+
+	pi_t * pi = (at_last == CONTROL_LOOP_SPEED) ? &pi_speed : &pi_current;
+
+	fmt_puts(at_last == CONTROL_LOOP_SPEED ? "boucle vitesse : " : "boucle courant : ");
+	fmt_puts(states[autotune.state]);
+	fmt_puts("\r\n");
+	put_param("Tu (ms)", autotune.tu * 1000.0f, 3);
+	put_param("a", autotune.a, 3);
+	put_param("Ku", autotune.ku, 4);
+	put_param("kp", pi->kp, 4);
+	put_param("ki", pi->ki, 4);
+
+	return 0;
+}
+
+SHELL_CMD(at, sh_autotune, "Reglage au relais (at i|w [d [eps [ref]]] | at stop)");
+SHELL_CMD(c, sh_current, "Boucle de courant (c <A> | c off)");
+SHELL_CMD(m, sh_move, "Trajectoire (m p <rad> | m v <rad/s> | m lim <v> <a> <j>)");
+SHELL_CMD(w, sh_speed, "Boucle de vitesse (w <rad/s> | w off | w out i|u | w kp|ki|kff|kacc|kpos|ramp <v>)");
@@ -0,0 +1,164 @@
+/**
+ ******************************************************************************
+ * @file	MOTOR.c
+ * @brief	Machine d'états de la puissance (pilote de grille et pont en H)
+ ******************************************************************************
+ */
+
+#include "MOTOR.h"
+
+#include "main.h"
+#include "tim.h"
+#include "CONTROL.h"
+
+volatile uint8_t motor_state = MOTOR_DISABLED;
+
+static uint32_t enable_request = 0;		// DWT à la demande d'activation
+static volatile uint8_t tripped = 0;	// motor_trip() pas encore traité par motor_post()
+static motor_stats_t stats = {0};
+
+static const char * names[] = {"desactive", "reset", "arme", "marche", "defaut"};
+
+// Coupure : sorties d'abord (état de repos, OSSI), puis MLI, pilote et boucles
+static void bridge_off(uint32_t request) {
+	__HAL_TIM_MOE_DISABLE_UNCONDITIONALLY(&htim1);
+
+	uint32_t cycles = DWT->CYCCNT - request;
+	stats.disable_last = cycles;
+	if (cycles > stats.disable_max) stats.disable_max = cycles;
+
+	__HAL_TIM_DISABLE(&htim7);
+	HAL_GPIO_WritePin(ISO_RESET_GPIO_Port, ISO_RESET_Pin, 0);
+	control_stop();
+
+	HAL_TIM_PWM_Stop(&htim1, TIM_CHANNEL_1);
+	HAL_TIMEx_PWMN_Stop(&htim1, TIM_CHANNEL_1);
+	HAL_TIM_PWM_Stop(&htim1, TIM_CHANNEL_2);
+	HAL_TIMEx_PWMN_Stop(&htim1, TIM_CHANNEL_2);
+}
+
+// Impulsion ISO_RESET : TIM7 en une impulsion, MOTOR_EV_RESET_DONE à la fin
+static void reset_start(uint32_t request) {
+	enable_request = request;
+	HAL_GPIO_WritePin(ISO_RESET_GPIO_Port, ISO_RESET_Pin, 1);
+	__HAL_TIM_SET_COUNTER(&htim7, 0);
+	__HAL_TIM_CLEAR_FLAG(&htim7, TIM_FLAG_UPDATE);
+	__HAL_TIM_ENABLE(&htim7);
+}
+
+// Fin du reset : MLI à tension nulle
+static void bridge_on() {
+	HAL_GPIO_WritePin(ISO_RESET_GPIO_Port, ISO_RESET_Pin, 0);
+	control_write_duty(0.0f);
+
+	HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_1);
+	HAL_TIMEx_PWMN_Start(&htim1, TIM_CHANNEL_1);
+	HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_2);
+	HAL_TIMEx_PWMN_Start(&htim1, TIM_CHANNEL_2);
+
+	// Protection déclenchée pendant le démarrage : MOE remis par PWM_Start
+	if (tripped) __HAL_TIM_MOE_DISABLE_UNCONDITIONALLY(&htim1);
+
+	uint32_t cycles = DWT->CYCCNT - enable_request;
+	stats.enable_last = cycles;
+	if (cycles > stats.enable_max) stats.enable_max = cycles;
+}
+
+void motor_init() {
+	motor_state = MOTOR_DISABLED;
+	HAL_GPIO_WritePin(ISO_RESET_GPIO_Port, ISO_RESET_Pin, 0);
+	__HAL_TIM_CLEAR_FLAG(&htim7, TIM_FLAG_UPDATE);
+	__HAL_TIM_ENABLE_IT(&htim7, TIM_IT_UPDATE);
+}
+
+// Protection (ISR de plus haute priorité, jamais masquée par motor_post) :
+// sorties coupées sur-le-champ, transition vers FAULT au prochain motor_post()
+void motor_trip() {
+	__HAL_TIM_MOE_DISABLE_UNCONDITIONALLY(&htim1);
+	tripped = 1;
+}
+
+// Traitement immédiat d'un événement (boucle principale ou ISR) ;
+// retourne -1 si l'événement est sans effet dans l'état courant
+int motor_post(uint8_t ev) {
+	uint32_t now = DWT->CYCCNT;
+	uint32_t basepri = __get_BASEPRI();
+	__set_BASEPRI_MAX(IRQ_BASEPRI(IRQ_PRIO_CURRENT));
+
+	uint8_t state = motor_state;
+	uint8_t next = state;
+
+	if (ev == MOTOR_EV_REARM && tripped) {
+		// Réarmement avant que le déclenchement ait été traité
+		tripped = 0;
+		if (state != MOTOR_FAULT) bridge_off(now);
+		next = MOTOR_DISABLED;
+	}
+	else if (ev == MOTOR_EV_FAULT || tripped) {
+		if (state != MOTOR_FAULT) {
+			bridge_off(now);
+			next = MOTOR_FAULT;
+		}
+	}
+	else switch (state) {
+	case MOTOR_DISABLED:
+		if (ev == MOTOR_EV_ENABLE || ev == MOTOR_EV_TOGGLE) {
+			reset_start(now);
+			next = MOTOR_RESETTING;
+		}
+		break;
+
+	case MOTOR_RESETTING:
+		if (ev == MOTOR_EV_RESET_DONE) {
+			bridge_on();
+			next = MOTOR_ARMED;
+		}
+		else if (ev == MOTOR_EV_DISABLE || ev == MOTOR_EV_TOGGLE) {
+			bridge_off(now);
+			next = MOTOR_DISABLED;
+		}
+		break;
+
+	case MOTOR_ARMED:
+	case MOTOR_RUNNING:
+		if (ev == MOTOR_EV_RUN) {
+			next = MOTOR_RUNNING;
+		}
+		else if (ev == MOTOR_EV_DISABLE || ev == MOTOR_EV_TOGGLE) {
+			bridge_off(now);
+			next = MOTOR_DISABLED;
+		}
+		break;
+
+	case MOTOR_FAULT:
+		if (ev == MOTOR_EV_REARM) {
+			next = MOTOR_DISABLED;
+		}
+		break;
+	}
+
+	int ret = 0;
+
+	if (next != state) {
+		motor_state = next;
+	}
+	else if (!(ev == MOTOR_EV_RUN && state == MOTOR_RUNNING)) {
+		stats.ignored++;
+		ret = -1;
+	}
+
+	__set_BASEPRI(basepri);
+
+	return ret;
+}
+
+const char * motor_state_name(uint8_t state) {
+	return (state <= MOTOR_FAULT) ? names[state] : "?";
+}
+
+void motor_get_stats(motor_stats_t * s) {
+	uint32_t basepri = __get_BASEPRI();
+	__set_BASEPRI_MAX(IRQ_BASEPRI(IRQ_PRIO_CURRENT));
+	*s = stats;
+	__set_BASEPRI(basepri);
+}
@@ -0,0 +1,247 @@
+/**
+ ******************************************************************************
+ * @file	PROTOCOL.c
+ * @brief	Protocole binaire (COBS + CRC-16) multiplexé avec le shell
+ ******************************************************************************
+ */
+
+#include "PROTOCOL.h"
+
+#include <stddef.h>
+
+#include "shell_uart.h"
+#include "main.h"
+
+// Trame reçue entre délimiteurs, message décodé
+#define MSG_MAX_SIZE COBS_MSG_SIZE(PROTOCOL_DATA_MAX_SIZE)
+#define COBS_MAX_SIZE COBS_ENCODED_MAX_SIZE(MSG_MAX_SIZE)
+
+typedef struct{
+	uint8_t id;
+	uint8_t size;
+	volatile void * ptr;
+} protocol_var_t;
+
+typedef struct{
+	uint8_t type;
+	int (* func)(const uint8_t * data, uint16_t len);
+} protocol_handler_t;
+
+static uint8_t rx_frame[COBS_MAX_SIZE];
+static uint16_t rx_len = 0;
+static uint8_t rx_overrun = 0;
+
+static int protocol_var_list_size = 0;
+static protocol_var_t protocol_var_list[PROTOCOL_VAR_LIST_MAX_SIZE];
+
+static int protocol_handler_list_size = 0;
+static protocol_handler_t protocol_handler_list[PROTOCOL_HANDLER_LIST_MAX_SIZE];
+
+static uint8_t stream_ids[PROTOCOL_STREAM_MAX_VARS];
+static uint8_t stream_n = 0;
+static uint16_t stream_period = 0;
+static uint32_t stream_last = 0;
+static uint8_t stream_seq = 0;
+
+static protocol_stats_t stats = {0};
+
+int protocol_send(uint8_t type, uint8_t seq, const uint8_t * data, uint16_t len) {
+	uint8_t frame[PROTOCOL_FRAME_MAX_SIZE(PROTOCOL_DATA_MAX_SIZE)];
+
+	if (len > PROTOCOL_DATA_MAX_SIZE) return -1;
+
+	uint16_t n = cobs_frame_encode(type, seq, data, len, frame);
+
+	return uart_write((char *)frame, n) == n ? 0 : -1;
+}
+
+int protocol_add_var(uint8_t id, volatile void * ptr, uint8_t size) {
+	if (size != 1 && size != 2 && size != 4) return -1;
+
+	if (protocol_var_list_size < PROTOCOL_VAR_LIST_MAX_SIZE) {
+		protocol_var_list[protocol_var_list_size].id = id;
+		protocol_var_list[protocol_var_list_size].size = size;
+		protocol_var_list[protocol_var_list_size].ptr = ptr;
+		protocol_var_list_size++;
+		return 0;
+	}
+
+	return -1;
+}
+
+int protocol_add_handler(uint8_t type, int (* pfunc)(const uint8_t * data, uint16_t len)) {
+	if (protocol_handler_list_size < PROTOCOL_HANDLER_LIST_MAX_SIZE) {
+		protocol_handler_list[protocol_handler_list_size].type = type;
+		protocol_handler_list[protocol_handler_list_size].func = pfunc;
+		protocol_handler_list_size++;
+		return 0;
+	}
+
+	return -1;
+}
+
+void protocol_get_stats(protocol_stats_t * s) {
+	*s = stats;
+}
+
+static protocol_var_t * protocol_find_var(uint8_t id) {
+	for (int i = 0 ; i < protocol_var_list_size ; i++) {
+		if (protocol_var_list[i].id == id) return &protocol_var_list[i];
+	}
+	return NULL;
+}
+
+// Lecture atomique (accès aligné de la taille de la variable), écrite en little-endian
+static uint8_t protocol_read_var(protocol_var_t * var, uint8_t * dst) {
+	uint32_t v;
+
+	switch (var->size) {
+	case 1: v = *(volatile uint8_t *)var->ptr; break;
+	case 2: v = *(volatile uint16_t *)var->ptr; break;
+	default: v = *(volatile uint32_t *)var->ptr; break;
+	}
+	for (uint8_t i = 0 ; i < var->size ; i++) {
+		dst[i] = v >> (8 * i);
+	}
+
+	return var->size;
+}
+
+static void protocol_ack(uint8_t type, uint8_t seq, uint8_t status) {
+	protocol_send(type | PROTOCOL_REPLY, seq, &status, 1);
+}
+
+static void protocol_read_vars(uint8_t seq, const uint8_t * data, uint16_t len) {
+	uint8_t reply[PROTOCOL_DATA_MAX_SIZE];
+	uint16_t n = 0;
+
+	for (uint16_t i = 0 ; i < len ; i++) {
+		protocol_var_t * var = protocol_find_var(data[i]);
+
+		if (var == NULL || n + 2 + var->size > PROTOCOL_DATA_MAX_SIZE) {
+			protocol_ack(PROTOCOL_READ_VARS, seq, PROTOCOL_ERR_ARG);
+			return;
+		}
+		reply[n++] = var->id;
+		reply[n++] = var->size;
+		n += protocol_read_var(var, &reply[n]);
+	}
+
+	protocol_send(PROTOCOL_READ_VARS | PROTOCOL_REPLY, seq, reply, n);
+}
+
+static uint8_t protocol_stream(const uint8_t * data, uint16_t len) {
+	uint16_t size = 4;	// horodatage
+
+	if (len < 2 || len - 2 > PROTOCOL_STREAM_MAX_VARS) return PROTOCOL_ERR_ARG;
+
+	for (uint16_t i = 2 ; i < len ; i++) {
+		protocol_var_t * var = protocol_find_var(data[i]);
+
+		if (var == NULL) return PROTOCOL_ERR_ARG;
+		size += var->size;
+	}
+	if (size > PROTOCOL_DATA_MAX_SIZE) return PROTOCOL_ERR_ARG;
+
+	stream_period = 0;
+	for (uint16_t i = 2 ; i < len ; i++) {
+		stream_ids[i - 2] = data[i];
+	}
+	stream_n = len - 2;
+	stream_last = HAL_GetTick();
+	stream_period = data[0] | (data[1] << 8);
+
+	return PROTOCOL_OK;
+}
+
+static void protocol_dispatch(const uint8_t * frame, uint16_t len) {
+	uint8_t msg[COBS_MAX_SIZE];
+	int n = cobs_frame_decode(frame, len, msg);
+
+	if (n == COBS_ERR_CODING) {
+		stats.cobs_errors++;
+		return;
+	}
+	if (n == COBS_ERR_CRC) {
+		stats.crc_errors++;
+		return;
+	}
+	stats.frames++;
+
+	uint8_t type = msg[0];
+	uint8_t seq = msg[1];
+	const uint8_t * data = &msg[2];
+	uint16_t data_len = n;
+
+	switch (type) {
+	case PROTOCOL_READ_VARS:
+		protocol_read_vars(seq, data, data_len);
+		return;
+
+	case PROTOCOL_STREAM:
+		protocol_ack(type, seq, protocol_stream(data, data_len));
+		return;
+
+	default:
+		for (int i = 0 ; i < protocol_handler_list_size ; i++) {
+			if (protocol_handler_list[i].type == type) {
+				protocol_ack(type, seq, protocol_handler_list[i].func(data, data_len));
+				return;
+			}
+		}
+		protocol_ack(type, seq, PROTOCOL_ERR_TYPE);
+	}
+}
+
+/**
+ * Octet reçu en mode binaire (appelé par shell_process, hors ISR)
+ * @return 1 tant que la trame n'est pas terminée, 0 pour rendre la main au shell
+ */
+int protocol_rx_byte(uint8_t ch) {
+	if (ch != 0) {
+		if (rx_len < sizeof(rx_frame)) {
+			rx_frame[rx_len++] = ch;
+		}
+		else {
+			rx_overrun = 1;
+		}
+		return 1;
+	}
+
+	// Délimiteur de début, ou délimiteurs consécutifs
+	if (rx_len == 0) return 1;
+
+	if (rx_overrun) {
+		stats.overruns++;
+	}
+	else {
+		protocol_dispatch(rx_frame, rx_len);
+	}
+	rx_len = 0;
+	rx_overrun = 0;
+
+	return 0;
+}
+
+/**
+ * Émission périodique des variables souscrites (boucle principale)
+ */
+void protocol_process() {
+	uint8_t data[PROTOCOL_DATA_MAX_SIZE];
+
+	if (stream_period == 0 || HAL_GetTick() - stream_last < stream_period) return;
+	stream_last += stream_period;
+
+	uint32_t now = HAL_GetTick();
+	uint16_t n = 0;
+
+	data[n++] = now;
+	data[n++] = now >> 8;
+	data[n++] = now >> 16;
+	data[n++] = now >> 24;
+	for (uint8_t i = 0 ; i < stream_n ; i++) {
+		n += protocol_read_var(protocol_find_var(stream_ids[i]), &data[n]);
+	}
+
+	protocol_send(PROTOCOL_STREAM | PROTOCOL_REPLY, stream_seq++, data, n);
+}
@@ -21,6 +21,16 @@
 #include "adc.h"
 
 /* USER CODE BEGIN 0 */
+static uint32_t * adc_buf = NULL;
+static uint32_t adc_len = 0;
+static uint8_t ovs_log2 = ADC_OVS_LOG2;
+static uint8_t ovs_shift = ADC_OVS_SHIFT;
+static volatile uint8_t norm_shift = ADC_FE_BITS - (12 + ADC_OVS_LOG2 - ADC_OVS_SHIFT);
+static int32_t awd_low = 0;				// fenêtre du chien de garde, unités 16 bits
+static int32_t awd_high = 0xFFFF;
+
+static void adc_ovs_apply(uint8_t ratio_log2, uint8_t shift);
+static void adc_awd_apply();
 
 /* USER CODE END 0 */
 
@@ -91,6 +101,21 @@ void MX_ADC1_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN ADC1_Init 2 */
+  // Conversions déclenchées par TIM1 TRGO2 au centre de la période MLI, DMA
+  // circulaire : une mesure moyennée par période, sans intervention du CPU
+  hadc1.Init.ContinuousConvMode = DISABLE;
+  hadc1.Init.ExternalTrigConv = ADC_EXTERNALTRIG_T1_TRGO2;
+  hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
+  hadc1.Init.EOCSelection = ADC_EOC_SEQ_CONV;
+  hadc1.Init.DMAContinuousRequests = ENABLE;
+  hadc1.Init.Overrun = ADC_OVR_DATA_OVERWRITTEN;
+  adc_ovs_apply(ovs_log2, ovs_shift);
+  hadc1.Init.Oversampling.TriggeredMode = ADC_TRIGGEREDMODE_SINGLE_TRIGGER;
+  hadc1.Init.Oversampling.OversamplingStopReset = ADC_REGOVERSAMPLING_CONTINUED_MODE;
+  if (HAL_ADC_Init(&hadc1) != HAL_OK)
+  {
+    Error_Handler();
+  }
 
   /* USER CODE END ADC1_Init 2 */
 
@@ -137,7 +162,7 @@ void HAL_ADC_MspInit(ADC_HandleTypeDef* adcHandle)
     __HAL_LINKDMA(adcHandle,DMA_Handle,hdma_adc1);
 
     /* ADC1 interrupt Init */
-    HAL_NVIC_SetPriority(ADC1_2_IRQn, 0, 0);
+    HAL_NVIC_SetPriority(ADC1_2_IRQn, IRQ_PRIO_PROTECTION, 0);
     HAL_NVIC_EnableIRQ(ADC1_2_IRQn);
   /* USER CODE BEGIN ADC1_MspInit 1 */
 
@@ -175,6 +200,130 @@ void HAL_ADC_MspDeInit(ADC_HandleTypeDef* adcHandle)
 
 /* USER CODE BEGIN 1 */
 
+// Rapport 2^ratio_log2 (0 : sans sur-échantillonnage), décalage en bits
+static void adc_ovs_apply(uint8_t ratio_log2, uint8_t shift)
+{
+  hadc1.Init.OversamplingMode = (ratio_log2 > 0) ? ENABLE : DISABLE;
+  hadc1.Init.Oversampling.Ratio = (ratio_log2 > 0) ? (uint32_t)(ratio_log2 - 1) << ADC_CFGR2_OVSR_Pos : 0;
+  hadc1.Init.Oversampling.RightBitShift = (uint32_t)shift << ADC_CFGR2_OVSS_Pos;
+}
+
+// Démarrage unique : l'ADC attend ensuite les déclenchements de TIM1, une
+// interruption DMA par séquence (demi-transfert inutile)
+void adc_start(uint32_t * buf, uint32_t len)
+{
+  adc_buf = buf;
+  adc_len = len;
+  HAL_ADC_Start_DMA(&hadc1, buf, len);
+  __HAL_DMA_DISABLE_IT(hadc1.DMA_Handle, DMA_IT_HT);
+}
+
+// Changement du sur-échantillonnage (boucle principale, boucle de courant
+// arrêtée) : l'ADC est arrêté et reconfiguré, une ou deux séquences sont perdues.
+// Refusé si le résultat sort de 12..16 bits ou si la séquence dépasse la période MLI.
+int adc_set_oversampling(uint8_t ratio_log2, uint8_t shift)
+{
+  uint32_t pwm_cycles = (TIM1->PSC + 1) * 2 * (TIM1->ARR + 1);
+  int32_t bits = 12 + ratio_log2 - shift;
+
+  if (ratio_log2 > ADC_OVS_MAX_LOG2 || shift > ratio_log2 || bits > ADC_FE_BITS) return -1;
+  if (((uint32_t)ADC_CHANNELS << ratio_log2) * ADC_CONV_CPU_CYCLES >= pwm_cycles) return -1;
+
+  HAL_ADC_Stop_DMA(&hadc1);
+
+  adc_ovs_apply(ratio_log2, shift);
+  if (HAL_ADC_Init(&hadc1) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  ovs_log2 = ratio_log2;
+  ovs_shift = shift;
+  norm_shift = ADC_FE_BITS - bits;
+  adc_awd_apply();
+
+  if (adc_buf != NULL)
+  {
+    adc_start(adc_buf, adc_len);
+  }
+
+  return 0;
+}
+
+void adc_get_oversampling(uint8_t * ratio_log2, uint8_t * shift)
+{
+  *ratio_log2 = ovs_log2;
+  *shift = ovs_shift;
+}
+
+// Décalage à gauche ramenant le résultat ADC sur ADC_FE_BITS bits
+uint8_t adc_norm_shift()
+{
+  return norm_shift;
+}
+
+// Auto-étalonnage linéarité / offset interne, ADC désactivé : avant adc_start()
+int adc_self_calibration()
+{
+  return (HAL_ADCEx_Calibration_Start(&hadc1, ADC_SINGLE_ENDED) == HAL_OK) ? 0 : -1;
+}
+
+// Chien de garde 1 sur toutes les voies régulières, ADC arrêté. Seuils
+// 12 bits : en sur-échantillonnage la comparaison porte sur DR[15:4]
+static void adc_awd_apply()
+{
+  ADC_AnalogWDGConfTypeDef awd = {0};
+  uint8_t shift = (ovs_log2 > 0) ? norm_shift + 4 : ADC_FE_BITS - 12;
+  uint32_t it = hadc1.Instance->IER & ADC_IT_AWD1;
+
+  awd.WatchdogNumber = ADC_ANALOGWATCHDOG_1;
+  awd.WatchdogMode = ADC_ANALOGWATCHDOG_ALL_REG;
+  awd.ITMode = DISABLE;
+  awd.HighThreshold = awd_high >> shift;
+  awd.LowThreshold = awd_low >> shift;
+  awd.FilteringConfig = ADC_AWD_FILTERING_NONE;
+  if (HAL_ADC_AnalogWDGConfig(&hadc1, &awd) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if (it)
+  {
+    adc_awd_enable(1);
+  }
+}
+
+// Fenêtre [low, high] en unités 16 bits avant étalonnage (boucle principale) :
+// l'ADC est arrêté pour la reprogrammation, une ou deux séquences sont perdues.
+// L'interruption reste dans l'état donné par adc_awd_enable().
+void adc_awd_set(int32_t low, int32_t high)
+{
+  awd_low = (low < 0) ? 0 : low;
+  awd_high = (high > 0xFFFF) ? 0xFFFF : high;
+
+  if (adc_buf != NULL)
+  {
+    HAL_ADC_Stop_DMA(&hadc1);
+  }
+  adc_awd_apply();
+  if (adc_buf != NULL)
+  {
+    adc_start(adc_buf, adc_len);
+  }
+}
+
+// Interruption du chien de garde (utilisable en ISR)
+void adc_awd_enable(uint8_t enable)
+{
+  if (enable)
+  {
+    __HAL_ADC_CLEAR_FLAG(&hadc1, ADC_FLAG_AWD1);
+    __HAL_ADC_ENABLE_IT(&hadc1, ADC_IT_AWD1);
+  }
+  else
+  {
+    __HAL_ADC_DISABLE_IT(&hadc1, ADC_IT_AWD1);
+  }
+}
+
 /* USER CODE END 1 */
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -82,10 +82,10 @@ void MX_GPIO_Init(void)
   HAL_GPIO_Init(ENC_Z_GPIO_Port, &GPIO_InitStruct);
 
   /* EXTI interrupt init*/
-  HAL_NVIC_SetPriority(EXTI9_5_IRQn, 0, 0);
+  HAL_NVIC_SetPriority(EXTI9_5_IRQn, IRQ_PRIO_BUTTON, 0);
   HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
 
-  HAL_NVIC_SetPriority(EXTI15_10_IRQn, 0, 0);
+  HAL_NVIC_SetPriority(EXTI15_10_IRQn, IRQ_PRIO_BUTTON, 0);
   HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
 
 }
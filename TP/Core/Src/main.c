@@ -29,8 +29,24 @@
 /* USER CODE BEGIN Includes */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
-#include "SHELL.h"
+#include "shell.h"
+#include "shell_uart.h"
+#include "PROTOCOL.h"
+#include "CONTROL.h"
+#include "MOTOR.h"
+#include "encoder.h"
+#include "velocity.h"
+#include "telemetry.h"
+#include "scope.h"
+#include "sysid.h"
+#include "filter.h"
+#include "fault.h"
+#include "sched.h"
+#include "prof.h"
+#include "cpumon.h"
+#include "fmt.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -40,25 +56,120 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+// Profilage (Debug) : un site par ISR ou tâche, un seul écrivain par site
+#define PROF_CLOCK() (DWT->CYCCNT)
+#ifdef PROF_ENABLE
+enum { PROF_ADC, PROF_TIM6, PROF_TIM7, PROF_UART, PROF_EXTI,
+	PROF_CTRL, PROF_SHELL, PROF_TELEM, PROF_HOUSE, PROF_SITES };
+#endif
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
 /* USER CODE BEGIN PM */
-#define ENC_TICKS_PER_REV 4000
-#define ENC_FREQ_ECH 50
+#define VEL_EDGE_TICKS 4		// x4 : un front montant TI1 tous les 4 pas
+#define VEL_TIMEOUT_S 0.5f		// sans front : vitesse nulle
+#define VEL_FILTER_HZ 0.0f		// passe-bas de l'estimation, 0 : aucun
+
+// Voies de télémétrie (enregistrées à chaque séquence ADC, avant décimation)
+#define TELEM_CH_ADC0 0			// value_filt[0] (16 bits)
+#define TELEM_CH_ADC1 1			// value_filt[1] (16 bits)
+#define TELEM_CH_CURRENT 2		// courant mesuré (mA)
+#define TELEM_CH_POSITION 3		// position codeur (pas, 32 bits de poids faible)
+#define TELEM_CH_SPEED 4		// vitesse mesurée (mrad/s)
+#define TELEM_CH_DUTY 5			// CCR1
+#define TELEM_CH_LOAD 6			// charge CPU de la dernière seconde (pour mille)
+#define TELEM_CH_JITTER 7		// dernier écart à la période TIM6 (cycles)
+
+// Voies du scope (int16, à chaque séquence ADC)
+#define SCOPE_CH_ADC0 0			// value_filt[0] - ADC_FE_MID (signé, 0 : courant nul)
+#define SCOPE_CH_ADC1 1			// value_filt[1] - ADC_FE_MID
+#define SCOPE_CH_DUTY 2			// CCR1
+#define SCOPE_CH_DELTA 3		// pas codeur depuis la séquence précédente
+
+#define SYSID_BLOCK 16			// périodes MLI par bloc de la régression mécanique
+#define SYSID_FIT_US 40			// ajustement : temps par appel de task_control (budget 100 µs)
+
+// Identification : excitation en cours, puis ajustement réparti sur plusieurs appels
+#define SYSID_IDLE 0
+#define SYSID_CAPTURE 1
+#define SYSID_FIT 2
+#define SYSID_SOLVE 3
+
+// Étalonnage des voies ADC (commande cal) : étapes avancées par task_control
+#define CAL_IDLE 0
+#define CAL_OFFSET 1			// accumulation à courant nul
+#define CAL_SETTLE 2			// établissement du courant avant le gain
+#define CAL_GAIN 3				// accumulation à courant établi
+
+// Exécutif : tick = interruption TIM6 (SPEED_LOOP_HZ)
+#define SCHED_MS(ms) ((ms) * SPEED_LOOP_HZ / 1000)
+#define SCHED_US(us) ((us) * (SystemCoreClock / 1000000))
+
+// Charge CPU
+#define CPU_LOAD_WARN 800			// seuil d'alerte par défaut (pour mille)
+#define CPU_LOAD_CAL_LOOPS 10000	// tours à vide mesurés au démarrage
+
+// Réarmement : séquences ADC neuves attendues avant la comparaison au seuil
+#define REARM_SEQUENCES 2
 /* USER CODE END PM */
 
 /* Private variables ---------------------------------------------------------*/
 
 /* USER CODE BEGIN PV */
-uint8_t hacheurStart = 0;
 int32_t ticks = 0;
-uint32_t value[2];
+enc_t encoder;
+vel_t velocity;
+uint32_t value[ADC_CHANNELS];				// résultats ADC (DMA)
+volatile uint32_t value_filt[ADC_CHANNELS];	// mesures filtrées, 16 bits, pour les boucles
+filt_t adc_filter[ADC_CHANNELS];
+uint32_t adc_fe_cycles_last = 0;
+uint32_t adc_fe_cycles_max = 0;
+adc_cal_t adc_cal = {{ADC_FE_MID, ADC_FE_MID}, {ADC_CAL_GAIN_ONE, ADC_CAL_GAIN_ONE}};
+volatile uint32_t adc_cal_remaining = 0;	// séquences encore à accumuler
+uint32_t adc_cal_sum[ADC_CHANNELS];
+uint32_t adc_cal_boot_cycles = 0;
+int adc_cal_boot_status = -1;
+uint8_t cal_state = CAL_IDLE;
+uint8_t cal_channel = 0;
+float cal_amps = 0.0f;
+uint32_t cal_t0 = 0;
+fault_t fault;
+uint32_t fault_reported = 0;
+sched_t scheduler;
+volatile uint32_t adc_sequences = 0;
+telem_t telemetry;
+scope_t scope;
+uint32_t scope_cnt = 0;
+sysid_t sysid;
+uint8_t sysid_state = SYSID_IDLE;
+uint16_t sysid_idx = 0;		// prochain échantillon du scope à ajuster
+uint16_t sysid_k = 0;		// échantillons déjà ajustés
+
+volatile uint32_t uart_isr_cycles_max = 0;
+volatile uint32_t uart_rx_events = 0;
+
+// Latence d'entrée de l'ISR de fin de séquence ADC (cycles depuis le déclenchement TRGO2)
+volatile uint32_t lat_min = UINT32_MAX;
+volatile uint32_t lat_max = 0;
+volatile uint32_t lat_n = 0;
+
+cpuload_t cpuload;
+uint32_t cpuload_reported = 0;
+jitter_t jitter_tick;						// entrées ISR TIM6 (boucle de vitesse, exécutif)
+jitter_t jitter_adc;						// entrées ISR fin de séquence ADC (boucle de courant)
+
+#ifdef PROF_ENABLE
+prof_site_t prof[PROF_SITES];
+const char * prof_names[PROF_SITES] = {
+		"adc", "tim6", "tim7", "uart", "exti", "ctrl", "shell", "telem", "house"
+};
+#endif
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 /* USER CODE BEGIN PFP */
+int overcurrent_rearm();
 
 /* USER CODE END PFP */
 
@@ -77,43 +188,1049 @@ int fonction(int argc, char ** argv) {
 	return 0;
 }
 
+// a : etat et latences, a 1 / a 0 : activation / desactivation, a 0 0 : remise a zero des max
 int hacheur(int argc, char ** argv){
 	if(argc == 2){
 		uint8_t cmd = atoi(argv[1]);
 
-		if(cmd == 1){
-			printf("Hacheur active !\r\n");
-			hacheurStart = 1;
-		}
-		else{
-			hacheurStart = 0;
-			printf("Hacheur desactive !\r\n");
+		if(motor_post(cmd == 1 ? MOTOR_EV_ENABLE : MOTOR_EV_DISABLE) != 0){
+			fmt_puts("sans effet (etat ");
+			fmt_puts(motor_state_name(motor_state));
+			fmt_puts(")\r\n");
+			return -1;
 		}
 	}
 
+	motor_stats_t s;
+	uint32_t cpu_mhz = SystemCoreClock / 1000000;
+
+	motor_get_stats(&s);
+	fmt_puts("hacheur ");
+	fmt_puts(motor_state_name(motor_state));
+	fmt_puts("\r\nactivation : ");
+	fmt_put_u32(s.enable_last / cpu_mhz);
+	fmt_puts(" us (max ");
+	fmt_put_u32(s.enable_max / cpu_mhz);
+	fmt_puts(", impulsion reset ");
+	fmt_put_u32(MOTOR_RESET_US);
+	fmt_puts(")\r\ndesactivation : ");
+	fmt_put_fixed(s.disable_last * 100 / cpu_mhz, 2);
+	fmt_puts(" us (max ");
+	fmt_put_fixed(s.disable_max * 100 / cpu_mhz, 2);
+	fmt_puts(")\r\n");
+
 	return 0;
 }
 
+// Commande en boucle ouverte : les boucles de courant et de vitesse sont arretees
+void set_duty(uint16_t cmd){
+	if(cmd > 1023) cmd = 1023;
+
+	control_stop();
+
+	TIM1->CCR1 = cmd;
+	TIM1->CCR2 = 1023 - cmd;
+	motor_post(MOTOR_EV_RUN);
+}
+
 int speed(int argc, char ** argv){
 	if(argc == 2){
-		float vitesse = atof(argv[1]);
-		printf("vitesse = %f\r\n",vitesse);
+		int32_t vitesse;	// centiemes de %
+
+		if(fmt_parse_fixed(argv[1], 2, &vitesse) != 0){
+			printf("vitesse invalide\r\n");
+			return -1;
+		}
+		fmt_puts("vitesse = ");
+		fmt_put_fixed(vitesse, 2);
+		fmt_puts("\r\n");
 
 		if(vitesse < 0) vitesse = 0;
-		else if(vitesse > 100) vitesse = 100;
+		else if(vitesse > 10000) vitesse = 10000;
 
-		float cmd = 1023 * (vitesse/100);
-		TIM1->CCR1 = (int)cmd;
+		int32_t cmd = (1023 * vitesse) / 10000;
+		set_duty(cmd);
 		printf("cmd = %d\r\n",(int)cmd);
+		printf("cmdn = %d\r\n",(int)(1023 - cmd));
+	}
+
+	return 0;
+}
+
+int proto_set_duty(const uint8_t * data, uint16_t len){
+	if(len != 2) return PROTOCOL_ERR_ARG;
+
+	uint16_t cmd = data[0] | (data[1] << 8);
+	if(cmd > 1023) return PROTOCOL_ERR_ARG;
+
+	set_duty(cmd);
+	return PROTOCOL_OK;
+}
+
+int proto_set_speed(const uint8_t * data, uint16_t len){
+	if(len != 2) return PROTOCOL_ERR_ARG;
+
+	int16_t vitesse = data[0] | (data[1] << 8);	// centiemes de %
+	if(vitesse < 0) vitesse = 0;
+	else if(vitesse > 10000) vitesse = 10000;
+
+	set_duty((1023 * (int32_t)vitesse) / 10000);
+	return PROTOCOL_OK;
+}
+
+int proto_motor(const uint8_t * data, uint16_t len){
+	if(len != 1 || data[0] > 2) return PROTOCOL_ERR_ARG;
+
+	int r;
+
+	if(data[0] == 2) r = overcurrent_rearm();
+	else r = motor_post(data[0] == 1 ? MOTOR_EV_ENABLE : MOTOR_EV_DISABLE);
+
+	return (r == 0) ? PROTOCOL_OK : PROTOCOL_ERR_ARG;
+}
+
+int proto_move(const uint8_t * data, uint16_t len){
+	if(len != 5 || data[0] > 1) return PROTOCOL_ERR_ARG;
+
+	int32_t value = (int32_t)(data[1] | (data[2] << 8) | (data[3] << 16) | ((uint32_t)data[4] << 24));
+	int r = (data[0] == 0) ? control_move_pos(value) : control_move_vel(value);
+
+	return (r == 0) ? PROTOCOL_OK : PROTOCOL_ERR_ARG;
+}
+
+int proto_telem(const uint8_t * data, uint16_t len){
+	if(len != 3) return PROTOCOL_ERR_ARG;
+
+	telem_config(&telemetry, data[0], data[1] | (data[2] << 8));
+	return PROTOCOL_OK;
+}
+
+// Trame de télémétrie, refusée si la file d'émission ne peut la prendre entière
+int telem_send(const uint8_t * data, uint16_t len){
+	static uint8_t seq = 0;
+
+	if(uart_tx_free() < PROTOCOL_FRAME_MAX_SIZE(len)) return -1;
+
+	return protocol_send(PROTOCOL_TELEM | PROTOCOL_REPLY, seq++, data, len);
+}
+
+int proto_scope(const uint8_t * data, uint16_t len){
+	if(len != 1) return PROTOCOL_ERR_ARG;
+
+	switch(data[0]){
+	case 0: scope_stop(&scope); return PROTOCOL_OK;
+	case 1: return scope_arm(&scope) == 0 ? PROTOCOL_OK : PROTOCOL_ERR_ARG;
+	case 2: scope_force(&scope); return PROTOCOL_OK;
+	default: return PROTOCOL_ERR_ARG;
+	}
+}
+
+int scope_send(const uint8_t * data, uint16_t len){
+	static uint8_t seq = 0;
+
+	if(uart_tx_free() < PROTOCOL_FRAME_MAX_SIZE(len)) return -1;
+
+	return protocol_send(PROTOCOL_SCOPE | PROTOCOL_REPLY, seq++, data, len);
+}
+
+int proto_stats(int argc, char ** argv){
+	protocol_stats_t stats;
+
+	protocol_get_stats(&stats);
+	printf("frames = %lu\r\n", (unsigned long)stats.frames);
+	printf("crc errors = %lu\r\n", (unsigned long)stats.crc_errors);
+	printf("cobs errors = %lu\r\n", (unsigned long)stats.cobs_errors);
+	printf("overruns = %lu\r\n", (unsigned long)stats.overruns);
+
+	return 0;
+}
+
+int isr_stats(int argc, char ** argv){
+	uint32_t max = uart_isr_cycles_max;
+
+	printf("uart isr max = %lu cycles (%lu us)\r\n",
+			(unsigned long)max, (unsigned long)(max / (SystemCoreClock / 1000000)));
+	printf("rx overflow = %lu\r\n", (unsigned long)uart_rx_overflow());
+	printf("rx errors = %lu\r\n", (unsigned long)uart_rx_errors());
+
+	if(argc == 2 && atoi(argv[1]) == 0){
+		uart_isr_cycles_max = 0;
+	}
+
+	return 0;
+}
+
+int enc_stats(int argc, char ** argv){
+	enc_snapshot_t snap;
+
+	enc_get(&encoder, &snap);
+	// position = tours * ENC_TICKS_PER_REV + angle (64 bits, pas de format)
+	fmt_puts("tours = ");
+	fmt_put_i32(snap.revolutions);
+	fmt_puts("\r\nangle = ");
+	fmt_put_u32(snap.angle);
+	fmt_puts(" / ");
+	fmt_put_u32(ENC_TICKS_PER_REV);
+	fmt_puts("\r\n");
+
+	return 0;
+}
+
+// v : vitesse (methodes M et M/T), v fc <Hz> : coupure du passe-bas (0 : aucun)
+int vel_stats(int argc, char ** argv){
+	if(argc == 3 && !strcmp(argv[1], "fc")){
+		int32_t fc;
+
+		if(fmt_parse_fixed(argv[2], 1, &fc) != 0){
+			fmt_puts("frequence invalide\r\n");
+			return -1;
+		}
+		vel_set_filter(&velocity, fc / 10.0f, SPEED_LOOP_HZ);
+	}
+
+	fmt_puts("w M = ");
+	fmt_put_fixed((int32_t)(ticks * (2 * M_PI * SPEED_LOOP_HZ * 100 / ENC_TICKS_PER_REV)), 2);
+	fmt_puts(" rad/s\r\nw M/T = ");
+	fmt_put_fixed((int32_t)(velocity.w_raw * 100), 2);
+	fmt_puts(" rad/s\r\nw filtre = ");
+	fmt_put_fixed((int32_t)(velocity.w * 100), 2);
+	fmt_puts(" rad/s\r\n");
+
+	return 0;
+}
+
+// t : compteurs, t <masque> <decimation> : voies et decimation, t off : arret
+int telem_stats(int argc, char ** argv){
+	telem_stats_t stats;
+
+	if(argc == 2 && !strcmp(argv[1], "off")){
+		telem_config(&telemetry, telemetry.mask, 0);
+	}
+	else if(argc == 3){
+		int32_t mask;
+		int32_t decimation;
+
+		if(fmt_parse_fixed(argv[1], 0, &mask) != 0 || fmt_parse_fixed(argv[2], 0, &decimation) != 0
+				|| mask < 0 || mask > 0xFF || decimation < 0 || decimation > 0xFFFF){
+			fmt_puts("parametres invalides\r\n");
+			return -1;
+		}
+		telem_config(&telemetry, mask, decimation);
+	}
+
+	telem_get_stats(&telemetry, &stats);
+	fmt_puts("masque = ");
+	fmt_put_u32(telemetry.mask);
+	fmt_puts(", decimation = ");
+	fmt_put_u32(telemetry.decimation);
+	fmt_puts("\r\nproduits = ");
+	fmt_put_u32(stats.produced);
+	fmt_puts(", perdus = ");
+	fmt_put_u32(stats.dropped);
+	fmt_puts(", file max = ");
+	fmt_put_u32(stats.peak);
+	fmt_puts("/");
+	fmt_put_u32(TELEM_RING_SIZE);
+	fmt_puts("\r\nemis = ");
+	fmt_put_u32(stats.sent);
+	fmt_puts(" en ");
+	fmt_put_u32(stats.frames);
+	fmt_puts(" trames, liaison occupee = ");
+	fmt_put_u32(stats.busy);
+	fmt_puts("\r\n");
+
+	return 0;
+}
+
+// o : etat, o arm | go | stop, o ch <masque>, o pre <n>, o dec <n>,
+// o trig <voie> <m|r|f|h|b> <niveau> (manuel, front montant/descendant, haut, bas)
+int scope_cmd(int argc, char ** argv){
+	static const char * states[] = {"arrete", "arme", "declenche", "vidage"};
+	static const char modes[] = "mrfhb";
+	int32_t v[2];
+
+	if(argc == 2 && !strcmp(argv[1], "arm")){
+		if(scope_arm(&scope) != 0){
+			fmt_puts("configuration invalide\r\n");
+			return -1;
+		}
+	}
+	else if(argc == 2 && !strcmp(argv[1], "go")){
+		scope_force(&scope);
+	}
+	else if(argc == 2 && !strcmp(argv[1], "stop")){
+		scope_stop(&scope);
+	}
+	else if(argc >= 3){
+		if(scope.state != SCOPE_IDLE){
+			fmt_puts("scope actif (o stop)\r\n");
+			return -1;
+		}
+		if(fmt_parse_fixed(argv[argc - 1], 0, &v[0]) != 0){
+			fmt_puts("valeur invalide\r\n");
+			return -1;
+		}
+
+		if(argc == 3 && !strcmp(argv[1], "ch") && v[0] > 0 && v[0] < (1 << SCOPE_CHANNELS)) scope.mask = v[0];
+		else if(argc == 3 && !strcmp(argv[1], "pre") && v[0] >= 0 && v[0] < SCOPE_BUFFER_SIZE) scope.pre = v[0];
+		else if(argc == 3 && !strcmp(argv[1], "dec") && v[0] > 0 && v[0] <= 0xFFFF) scope.decimation = v[0];
+		else if(argc == 5 && !strcmp(argv[1], "trig") && strchr(modes, argv[3][0]) != NULL
+				&& fmt_parse_fixed(argv[2], 0, &v[1]) == 0 && v[1] >= 0 && v[1] < SCOPE_CHANNELS
+				&& v[0] >= INT16_MIN && v[0] <= INT16_MAX){
+			scope.trig_ch = v[1];
+			scope.trig_mode = strchr(modes, argv[3][0]) - modes;
+			scope.trig_level = v[0];
+		}
+		else{
+			fmt_puts("parametre invalide\r\n");
+			return -1;
+		}
+	}
+
+	fmt_puts("etat = ");
+	fmt_puts(states[scope.state]);
+	fmt_puts(", masque = ");
+	fmt_put_u32(scope.mask);
+	fmt_puts(", pre = ");
+	fmt_put_u32(scope.pre);
+	fmt_puts(", dec = ");
+	fmt_put_u32(scope.decimation);
+	fmt_puts("\r\ntrig : voie ");
+	fmt_put_u32(scope.trig_ch);
+	fmt_puts(" mode ");
+	fmt_put_u32(scope.trig_mode);
+	fmt_puts(" niveau ");
+	fmt_put_i32(scope.trig_level);
+	fmt_puts("\r\n");
+
+	return 0;
+}
+
+// id <biais> <amplitude> [hold] : excitation SBPA sur u, capture par le scope
+// (courant, CCR1, pas codeur a chaque periode MLI), ajustement a la fin
+int sysid_cmd(int argc, char ** argv){
+	int32_t bias;
+	int32_t amplitude;
+	int32_t hold = SYSID_HOLD;
+
+	if(argc < 3 || argc > 4 || fmt_parse_fixed(argv[1], 3, &bias) != 0 || fmt_parse_fixed(argv[2], 3, &amplitude) != 0
+			|| (argc == 4 && (fmt_parse_fixed(argv[3], 0, &hold) != 0 || hold < 1 || hold > 0xFFFF))){
+		fmt_puts("id <biais> <amplitude> [hold]\r\n");
+		return -1;
+	}
+
+	scope_stop(&scope);
+	scope.mask = (1 << SCOPE_CH_ADC0) | (1 << SCOPE_CH_DUTY) | (1 << SCOPE_CH_DELTA);
+	scope.pre = 0;
+	scope.decimation = 1;
+	scope.trig_mode = SCOPE_TRIG_MANUAL;
+
+	if(control_sysid_start(bias / 1000.0f, amplitude / 1000.0f, hold) != 0){
+		fmt_puts("excitation hors plage\r\n");
+		return -1;
+	}
+	scope_arm(&scope);
+	scope_force(&scope);
+	sysid_state = SYSID_CAPTURE;
+
+	return 0;
+}
+
+// Début de l'ajustement sur la capture terminée (gardée jusqu'à la fin : pas de vidage)
+void sysid_fit_start(){
+	float te = (float)((TIM1->PSC + 1) * 2 * (TIM1->ARR + 1)) / (float)SystemCoreClock;
+
+	sysid_init(&sysid, te, VBUS, ENC_TICKS_PER_REV, SYSID_BLOCK);
+	sysid_idx = scope.start;
+	sysid_k = 0;
+	sysid_state = SYSID_FIT;
+}
+
+// Échantillons suivants, du plus ancien au plus récent, pendant SYSID_FIT_US au plus
+// (sysid_add : double émulé, quelques µs par échantillon ; au moins un par appel)
+void sysid_fit_step(){
+	uint32_t start = DWT->CYCCNT;
+	uint32_t budget = SYSID_FIT_US * (SystemCoreClock / 1000000);
+
+	// Scope relancé par une commande pendant l'ajustement : capture perdue
+	if(scope.state != SCOPE_DONE){
+		fmt_puts("identification : capture interrompue\r\n");
+		sysid_state = SYSID_IDLE;
+		return;
+	}
+
+	do{
+		// Voies rangées dans l'ordre croissant : ADC0, DUTY, DELTA
+		const int16_t * s = &scope.buf[(uint32_t)sysid_idx * scope.n];
+		float u = 2.0f * (float)s[1] / (float)(TIM1->ARR + 1) - 1.0f;
+		float i = (float)s[0] / CURRENT_ADC_SCALE * CURRENT_A_PER_LSB;
+
+		sysid_add(&sysid, u, i, s[2]);
+		if(++sysid_idx >= scope.depth) sysid_idx = 0;
+		if(++sysid_k >= scope.depth){
+			sysid_state = SYSID_SOLVE;
+			return;
+		}
+	} while(DWT->CYCCNT - start < budget);
+}
+
+// Résolution et affichage, dans un appel à part
+void sysid_fit_solve(){
+	sysid_result_t res;
+
+	sysid_state = SYSID_IDLE;
+	if(sysid_solve(&sysid, &res) != 0){
+		fmt_puts("identification : pas de modele electrique valide\r\n");
+		return;
+	}
+	fmt_puts("R = ");
+	fmt_put_fixed((int32_t)(res.r * 1000.0f), 3);
+	fmt_puts(" Ohm\r\nL = ");
+	fmt_put_fixed((int32_t)(res.l * 1e6f), 3);
+	fmt_puts(" mH\r\nke = ");
+	fmt_put_fixed((int32_t)(res.ke * 1e5f), 5);
+	fmt_puts(" V.s/rad\r\nJ = ");
+	fmt_put_fixed((int32_t)(res.j * 1e8f), 1);
+	fmt_puts(" g.cm2\r\nf = ");
+	fmt_put_fixed((int32_t)(res.f * 1e8f), 2);
+	fmt_puts(" uN.m.s/rad\r\nR2 elec = ");
+	fmt_put_fixed((int32_t)(res.r2_elec * 10000.0f), 4);
+	fmt_puts(", R2 meca = ");
+	fmt_put_fixed((int32_t)(res.r2_mech * 10000.0f), 4);
+	fmt_puts("\r\n");
+}
+
+// adc : etat, adc ovs <log2 rapport> <decalage> : sur-echantillonnage,
+// adc f <voie> none|iir|ma [ordre] : filtre, adc 0 : remise a zero du max
+int adc_cmd(int argc, char ** argv){
+	static const char * types[] = {"none", "iir", "ma"};
+	int32_t v[2];
+
+	if(argc == 4 && !strcmp(argv[1], "ovs")){
+		if(control_current_enabled() || control_speed_enabled()){
+			fmt_puts("boucles actives (c off)\r\n");
+			return -1;
+		}
+		if(fmt_parse_fixed(argv[2], 0, &v[0]) != 0 || fmt_parse_fixed(argv[3], 0, &v[1]) != 0
+				|| v[0] < 0 || v[1] < 0 || adc_set_oversampling(v[0], v[1]) != 0){
+			fmt_puts("sur-echantillonnage invalide (12 a 16 bits, sequence < periode MLI)\r\n");
+			return -1;
+		}
+	}
+	else if((argc == 4 || argc == 5) && !strcmp(argv[1], "f")){
+		uint8_t type = 0;
+
+		while(type < 3 && strcmp(argv[3], types[type])) type++;
+		v[1] = 0;
+		if(fmt_parse_fixed(argv[2], 0, &v[0]) != 0 || v[0] < 0 || v[0] >= ADC_CHANNELS || type == 3
+				|| (argc == 5 && fmt_parse_fixed(argv[4], 0, &v[1]) != 0)
+				|| filt_config(&adc_filter[v[0]], type, v[1]) != 0){
+			fmt_puts("filtre invalide (iir : ordre 1 a 8, ma : ordre 1 a 4)\r\n");
+			return -1;
+		}
+	}
+	else if(argc == 2 && !strcmp(argv[1], "0")){
+		adc_fe_cycles_max = 0;
+	}
+
+	uint8_t log2;
+	uint8_t shift;
+
+	adc_get_oversampling(&log2, &shift);
+	fmt_puts("ovs : x");
+	fmt_put_u32(1 << log2);
+	fmt_puts(" >> ");
+	fmt_put_u32(shift);
+	fmt_puts(" (");
+	fmt_put_u32(12 + log2 - shift);
+	fmt_puts(" bits)\r\n");
+	for(uint8_t c = 0 ; c < ADC_CHANNELS ; c++){
+		fmt_puts("voie ");
+		fmt_put_u32(c);
+		fmt_puts(" : ");
+		fmt_puts(types[adc_filter[c].type]);
+		fmt_puts(" ");
+		fmt_put_u32(adc_filter[c].order);
+		fmt_puts(", brut ");
+		fmt_put_u32(value[c]);
+		fmt_puts(", filtre ");
+		fmt_put_u32(value_filt[c]);
+		fmt_puts("\r\n");
+	}
+	fmt_puts("cycles = ");
+	fmt_put_u32(adc_fe_cycles_last);
+	fmt_puts(" (max ");
+	fmt_put_u32(adc_fe_cycles_max);
+	fmt_puts(")\r\n");
+
+	return 0;
+}
+
+// Début de l'accumulation de ADC_CAL_SAMPLES séquences avant étalonnage
+// (16 bits) par l'ISR ADC
+void adc_cal_accumulate(){
+	memset(adc_cal_sum, 0, sizeof(adc_cal_sum));
+	cal_t0 = HAL_GetTick();
+	adc_cal_remaining = ADC_CAL_SAMPLES;
+}
+
+// Offsets à courant nul : pont désactivé (ISO_RESET bas), compteur TIM1 seul
+// pour les déclenchements ADC. Terminé par adc_cal_process().
+int adc_offset_start(){
+	if(cal_state != CAL_IDLE || motor_state != MOTOR_DISABLED) return -1;
+
+	HAL_GPIO_WritePin(ISO_RESET_GPIO_Port, ISO_RESET_Pin, 0);
+	__HAL_TIM_ENABLE(&htim1);
+	adc_cal_accumulate();
+	cal_state = CAL_OFFSET;
+
+	return 0;
+}
+
+// Gain d'une voie : rapport cyclique u en boucle ouverte, courant de
+// référence amps (A, signe vu par la voie) mesuré par un appareil externe.
+// Terminé par adc_cal_process().
+int adc_gain_start(uint8_t c, float u, float amps){
+	if(cal_state != CAL_IDLE || (motor_state != MOTOR_ARMED && motor_state != MOTOR_RUNNING)
+			|| control_active()) return -1;
+
+	control_write_duty(u);
+	cal_channel = c;
+	cal_amps = amps;
+	cal_t0 = HAL_GetTick();
+	cal_state = CAL_SETTLE;
+
+	return 0;
+}
+
+// Offsets inchangés en cas d'échec
+int adc_offset_apply(const int32_t * mean){
+	for(uint8_t c = 0 ; c < ADC_CHANNELS ; c++){
+		if(abs(mean[c] - ADC_FE_MID) > ADC_CAL_OFFSET_MAX) return -1;
+	}
+	for(uint8_t c = 0 ; c < ADC_CHANNELS ; c++){
+		adc_cal.offset[c] = mean[c];
+	}
+
+	return 0;
+}
+
+int adc_gain_apply(const int32_t * mean){
+	float expected = cal_amps / CURRENT_A_PER_LSB * CURRENT_ADC_SCALE;
+	int32_t measured = mean[cal_channel] - adc_cal.offset[cal_channel];
+
+	if(abs(measured) < ADC_CAL_OFFSET_MAX / 16) return -1;	// courant trop faible
+	float gain = expected / (float)measured * ADC_CAL_GAIN_ONE;
+	if(gain < 0.5f * ADC_CAL_GAIN_ONE || gain >= 2.0f * ADC_CAL_GAIN_ONE) return -1;
+	adc_cal.gain[cal_channel] = (int32_t)(gain + 0.5f);
+
+	return 0;
+}
+
+// Étape suivante de l'étalonnage en cours, sans attente
+// @return 1 tant qu'il est en cours, 0 terminé avec succès, -1 en échec
+int adc_cal_process(){
+	int32_t mean[ADC_CHANNELS];
+	int ret = 0;
+
+	if(cal_state == CAL_IDLE) return 0;
+
+	// Pont activé (offsets), arrêté ou repris par une boucle (gain) pendant la mesure
+	uint8_t lost = (cal_state == CAL_OFFSET) ? motor_state != MOTOR_DISABLED
+			: (motor_state != MOTOR_ARMED && motor_state != MOTOR_RUNNING) || control_active();
+
+	if(lost){
+		adc_cal_remaining = 0;
+		cal_state = CAL_IDLE;
+		return -1;
+	}
+
+	if(cal_state == CAL_SETTLE){
+		if(HAL_GetTick() - cal_t0 >= ADC_CAL_SETTLE_MS){
+			adc_cal_accumulate();
+			cal_state = CAL_GAIN;
+		}
+		return 1;
+	}
+
+	if(adc_cal_remaining){
+		if(HAL_GetTick() - cal_t0 <= ADC_CAL_TIMEOUT_MS) return 1;
+		adc_cal_remaining = 0;
+		ret = -1;
+	}
+	else{
+		for(uint8_t c = 0 ; c < ADC_CHANNELS ; c++){
+			mean[c] = (adc_cal_sum[c] + ADC_CAL_SAMPLES / 2) / ADC_CAL_SAMPLES;
+		}
+	}
+
+	if(cal_state == CAL_OFFSET){
+		__HAL_TIM_DISABLE(&htim1);
+		if(ret == 0) ret = adc_offset_apply(mean);
+	}
+	else{
+		control_write_duty(0.0f);
+		if(ret == 0) ret = adc_gain_apply(mean);
+	}
+	cal_state = CAL_IDLE;
+
+	return ret;
+}
+
+// Fenêtre du chien de garde : +-CURRENT_TRIP autour des offsets, la plus
+// étroite des deux voies (un seul chien de garde pour toute la séquence)
+void overcurrent_config(){
+	int32_t low = 0;
+	int32_t high = 0xFFFF;
+
+	for(uint8_t c = 0 ; c < ADC_CHANNELS ; c++){
+		int32_t half = (int32_t)(CURRENT_TRIP / CURRENT_A_PER_LSB * CURRENT_ADC_SCALE
+				* ADC_CAL_GAIN_ONE / adc_cal.gain[c]);
+
+		if(adc_cal.offset[c] - half > low) low = adc_cal.offset[c] - half;
+		if(adc_cal.offset[c] + half < high) high = adc_cal.offset[c] + half;
+	}
+	adc_awd_set(low, high);
+}
+
+void fault_print(){
+	if(fault_latched(&fault) == FAULT_NONE){
+		fmt_puts("aucun defaut");
+	}
+	else{
+		fmt_puts("DEFAUT surintensite voie ");
+		fmt_put_u32(fault.channel);
+		fmt_puts(" : ");
+		fmt_put_fixed(fault.value, 3);
+		fmt_puts(" A a t = ");
+		fmt_put_u32(fault.tick);
+		fmt_puts(" ms");
+	}
+	fmt_puts(" (");
+	fmt_put_u32(fault.trips);
+	fmt_puts(" declenchements)\r\n");
+}
 
-		float cmdn = 1023 - cmd;
-		TIM1->CCR2 = (int)cmdn;
-		printf("cmdn = %d\r\n",(int)cmdn);
+// Courant le plus fort des voies sur une séquence ADC neuve (A, non filtré).
+// Pont coupé, le compteur TIM1 est arrêté depuis le déclenchement : value[]
+// et value_filt[] restent figés sur l'échantillon en défaut. Compteur relancé
+// (MOE à 0, sorties au repos) le temps de REARM_SEQUENCES séquences, comme
+// adc_offset_start(), attente bornée à quelques périodes MLI.
+int overcurrent_measure(float * amps){
+	uint32_t period = (TIM1->PSC + 1) * 2 * (TIM1->ARR + 1);
+	uint8_t running = (TIM1->CR1 & TIM_CR1_CEN) != 0;
+	uint32_t seq0 = adc_sequences;
+	uint32_t t0 = DWT->CYCCNT;
+	int ret = 0;
+
+	if(!running) __HAL_TIM_ENABLE(&htim1);
+	while(adc_sequences - seq0 < REARM_SEQUENCES){
+		if(DWT->CYCCNT - t0 > (REARM_SEQUENCES + 2) * period){
+			ret = -1;
+			break;
+		}
+	}
+	if(!running) __HAL_TIM_DISABLE(&htim1);
+	if(ret != 0) return -1;
+
+	uint8_t norm = adc_norm_shift();
+	int32_t worst = 0;
+
+	for(uint8_t c = 0 ; c < ADC_CHANNELS ; c++){
+		int32_t d = (((int32_t)(value[c] << norm) - adc_cal.offset[c]) * adc_cal.gain[c]) >> ADC_CAL_GAIN_SHIFT;
+
+		if(abs(d) > worst) worst = abs(d);
 	}
+	*amps = (float)worst / CURRENT_ADC_SCALE * CURRENT_A_PER_LSB;
+
+	return 0;
+}
+
+// fault : etat, fault r : rearmement si le courant est revenu sous le seuil
+// Réarmement : défaut verrouillé et courant revenu sous le seuil (mesure neuve)
+int overcurrent_rearm(){
+	float amps;
+
+	if(fault_latched(&fault) == FAULT_NONE) return -1;
+	if(overcurrent_measure(&amps) != 0 || amps >= CURRENT_TRIP) return -1;
+	if(fault_rearm(&fault) != 0) return -1;
+
+	__HAL_TIM_CLEAR_FLAG(&htim1, TIM_FLAG_BREAK);
+	adc_awd_enable(1);
+	motor_post(MOTOR_EV_REARM);
 
 	return 0;
 }
 
+int fault_cmd(int argc, char ** argv){
+	if(argc == 2 && !strcmp(argv[1], "r") && overcurrent_rearm() != 0){
+		fmt_puts("pas de defaut ou courant encore au-dessus du seuil\r\n");
+		return -1;
+	}
+
+	fault_print();
+
+	return 0;
+}
+
+void cal_print(){
+	for(uint8_t c = 0 ; c < ADC_CHANNELS ; c++){
+		fmt_puts("voie ");
+		fmt_put_u32(c);
+		fmt_puts(" : offset ");
+		fmt_put_i32(adc_cal.offset[c] - ADC_FE_MID);
+		fmt_puts(", gain ");
+		fmt_put_fixed((adc_cal.gain[c] * 10000) >> ADC_CAL_GAIN_SHIFT, 4);
+		fmt_puts("\r\n");
+	}
+	fmt_puts("demarrage : ");
+	fmt_puts(adc_cal_boot_status == 0 ? "ok, " : "echec, ");
+	fmt_put_u32(adc_cal_boot_cycles / (SystemCoreClock / 1000000));
+	fmt_puts(" us\r\n");
+}
+
+// cal : constantes, cal o : offsets (hacheur arrete),
+// cal g <voie> <u> <courant A> : gain, cal r : valeurs nominales.
+// Mesures terminées par task_control, résultat affiché à la fin.
+int cal_cmd(int argc, char ** argv){
+	if(argc > 1 && cal_state != CAL_IDLE){
+		fmt_puts("etalonnage en cours\r\n");
+		return -1;
+	}
+
+	if(argc == 2 && !strcmp(argv[1], "o")){
+		if(adc_offset_start() != 0){
+			fmt_puts("echec (hacheur actif)\r\n");
+			return -1;
+		}
+		return 0;
+	}
+	else if(argc == 5 && !strcmp(argv[1], "g")){
+		int32_t c;
+		int32_t u;
+		int32_t amps;
+
+		if(fmt_parse_fixed(argv[2], 0, &c) != 0 || c < 0 || c >= ADC_CHANNELS
+				|| fmt_parse_fixed(argv[3], 3, &u) != 0 || u < -950 || u > 950
+				|| fmt_parse_fixed(argv[4], 3, &amps) != 0){
+			fmt_puts("usage : cal g <voie> <u> <courant A>\r\n");
+			return -1;
+		}
+		if(adc_gain_start(c, u / 1000.0f, amps / 1000.0f) != 0){
+			fmt_puts("echec (hacheur arrete ou boucles actives)\r\n");
+			return -1;
+		}
+		return 0;
+	}
+	else if(argc == 2 && !strcmp(argv[1], "r")){
+		for(uint8_t c = 0 ; c < ADC_CHANNELS ; c++){
+			adc_cal.offset[c] = ADC_FE_MID;
+			adc_cal.gain[c] = ADC_CAL_GAIN_ONE;
+		}
+		overcurrent_config();
+	}
+
+	cal_print();
+
+	return 0;
+}
+
+// Fin d'un étalonnage lancé par cal : protection recalée, résultat
+void cal_report(uint8_t gain, int ret){
+	if(ret != 0){
+		fmt_puts(gain ? "echec (hacheur arrete, boucles actives ou gain hors 0,5..2)\r\n"
+				: "echec (hacheur actif ou offset hors tolerance)\r\n");
+	}
+	overcurrent_config();
+	cal_print();
+}
+
+uint32_t sched_clock(){
+	return DWT->CYCCNT;
+}
+
+// Mode dégradé : puissance coupée, seules les tâches essentielles tournent
+void sched_fallback(uint8_t task){
+	motor_post(MOTOR_EV_DISABLE);
+	fmt_puts("mode degrade : depassements de ");
+	fmt_puts(scheduler.tasks[task].name);
+	fmt_puts(" (sched r)\r\n");
+}
+
+// Commandes binaires, fin d'identification et d'étalonnage, signalement des défauts
+void task_control(){
+	PROF_START(t0);
+
+	protocol_process();
+	if(fault_latched(&fault) != FAULT_NONE && motor_state != MOTOR_FAULT) motor_post(MOTOR_EV_FAULT);
+	if(fault.trips != fault_reported){
+		fault_reported = fault.trips;
+		fault_print();
+	}
+	if(sysid_state == SYSID_CAPTURE && (scope.state == SCOPE_DONE || scope.state == SCOPE_IDLE)){
+		// Capture pleine (ajustement avant le vidage) ou interrompue : fin de l'excitation
+		control_stop();
+		control_write_duty(0.0f);
+		if(scope.state == SCOPE_DONE) sysid_fit_start();
+		else sysid_state = SYSID_IDLE;
+	}
+	else if(sysid_state == SYSID_FIT) sysid_fit_step();
+	else if(sysid_state == SYSID_SOLVE) sysid_fit_solve();
+	if(cal_state != CAL_IDLE){
+		uint8_t gain = (cal_state != CAL_OFFSET);
+		int ret = adc_cal_process();
+
+		if(ret != 1) cal_report(gain, ret);
+	}
+	PROF_STOP(prof[PROF_CTRL], t0);
+}
+
+void task_shell(){
+	PROF_START(t0);
+
+	shell_process();
+	PROF_STOP(prof[PROF_SHELL], t0);
+}
+
+void task_telemetry(){
+	PROF_START(t0);
+
+	telem_process(&telemetry, telem_send, PROTOCOL_DATA_MAX_SIZE);
+	// Capture d'identification vidée une fois l'ajustement terminé
+	if(sysid_state == SYSID_IDLE) scope_dump(&scope, scope_send, PROTOCOL_DATA_MAX_SIZE);
+	PROF_STOP(prof[PROF_TELEM], t0);
+}
+
+void task_housekeeping(){
+	PROF_START(t0);
+
+	// Pas de texte au milieu des trames de télémétrie ou du vidage du scope
+	if(telemetry.decimation == 0 && scope.state != SCOPE_DONE){
+		fmt_put_u32(value_filt[0]);
+		fmt_puts("\t");
+		fmt_put_u32(value_filt[1]);
+		fmt_puts("\t");
+		fmt_put_u32(adc_sequences);
+		fmt_puts(" seq/s\r\n");
+	}
+	adc_sequences = 0;
+
+	cpuload_update(&cpuload, DWT->CYCCNT);
+	if(cpuload.warnings != cpuload_reported && telemetry.decimation == 0 && scope.state != SCOPE_DONE){
+		cpuload_reported = cpuload.warnings;
+		fmt_puts("ATTENTION charge CPU ");
+		fmt_put_fixed(cpuload.load, 1);
+		fmt_puts(" % (load)\r\n");
+	}
+	PROF_STOP(prof[PROF_HOUSE], t0);
+}
+
+// sched : statistiques des taches (us), sched r : remise a zero et sortie du mode degrade
+int sched_cmd(int argc, char ** argv){
+	uint32_t cpu_mhz = SystemCoreClock / 1000000;
+
+	if(argc == 2 && !strcmp(argv[1], "r")) sched_clear(&scheduler);
+
+	fmt_puts(scheduler.degraded ? "mode degrade\r\n" : "mode normal\r\n");
+	fmt_puts("tache\tT ms\texec\tmax\tbudget\tjitter\tmanq.\tdepass.\r\n");
+	for(uint8_t i = 0 ; i < scheduler.n ; i++){
+		const sched_task_t * t = &scheduler.tasks[i];
+
+		fmt_puts(t->name);
+		fmt_puts("\t");
+		fmt_put_u32(t->period * 1000 / SPEED_LOOP_HZ);
+		fmt_puts("\t");
+		fmt_put_u32(t->exec_last / cpu_mhz);
+		fmt_puts("\t");
+		fmt_put_u32(t->exec_max / cpu_mhz);
+		fmt_puts("\t");
+		fmt_put_u32(t->budget / cpu_mhz);
+		fmt_puts("\t");
+		fmt_put_u32((t->runs > 0) ? (t->latency_max - t->latency_min) / cpu_mhz : 0);
+		fmt_puts("\t");
+		fmt_put_u32(t->misses);
+		fmt_puts("\t");
+		fmt_put_u32(t->overruns);
+		fmt_puts("\r\n");
+	}
+
+	return 0;
+}
+
+// lat : latence d'entree de l'ISR DMA ADC (boucle de courant), declenchement
+// TRGO2 compris, mesuree a chaque sequence ; lat r : remise a zero. Essai :
+// hacheur actif, lat r, saturer la liaison depuis le PC, puis lat
+int lat_cmd(int argc, char ** argv){
+	uint32_t cpu_mhz = SystemCoreClock / 1000000;
+
+	if(argc == 2 && !strcmp(argv[1], "r")){
+		uint32_t basepri = __get_BASEPRI();
+
+		__set_BASEPRI_MAX(IRQ_BASEPRI(IRQ_PRIO_CURRENT));
+		lat_min = UINT32_MAX;
+		lat_max = 0;
+		lat_n = 0;
+		uart_rx_events = 0;
+		uart_isr_cycles_max = 0;
+		__set_BASEPRI(basepri);
+	}
+	if(lat_n == 0){
+		fmt_puts("aucune mesure (hacheur arrete ?)\r\n");
+		return 0;
+	}
+
+	// Ticks TIM1 en cycles : centièmes de µs
+	fmt_puts("latence min = ");
+	fmt_put_fixed(lat_min * 100 / cpu_mhz, 2);
+	fmt_puts(" us, max = ");
+	fmt_put_fixed(lat_max * 100 / cpu_mhz, 2);
+	fmt_puts(" us, gigue = ");
+	fmt_put_fixed((lat_max - lat_min) * 100 / cpu_mhz, 2);
+	fmt_puts(" us (");
+	fmt_put_u32(lat_n);
+	fmt_puts(" sequences)\r\nevenements rx = ");
+	fmt_put_u32(uart_rx_events);
+	fmt_puts(", isr uart max = ");
+	fmt_put_u32(uart_isr_cycles_max / cpu_mhz);
+	fmt_puts(" us\r\n");
+
+	return 0;
+}
+
+void jitter_print(const char * name, const jitter_t * src){
+	jitter_t j;
+	uint32_t basepri = __get_BASEPRI();
+
+	// Copie cohérente : l'écrivain le plus prioritaire est la boucle de courant
+	__set_BASEPRI_MAX(IRQ_BASEPRI(IRQ_PRIO_CURRENT));
+	j = *src;
+	__set_BASEPRI(basepri);
+
+	fmt_puts(name);
+	fmt_puts("\t");
+	fmt_put_u32(j.period);
+	fmt_puts("\t");
+	fmt_put_u32(j.n);
+	fmt_puts("\t");
+	fmt_put_i32((j.n > 0) ? j.dev_min : 0);
+	fmt_puts("\t");
+	fmt_put_i32((j.n > 0) ? j.dev_max : 0);
+	fmt_puts("\t");
+	fmt_put_u32(jitter_mean(&j));
+	fmt_puts("\t");
+	fmt_put_u32(j.gaps);
+	fmt_puts("\t");
+	for(uint8_t k = 0 ; k < JITTER_HIST_BINS ; k++){
+		if(j.hist[k] == 0) continue;
+		fmt_put_u32(k);
+		fmt_puts(":");
+		fmt_put_u32(j.hist[k]);
+		fmt_puts(" ");
+	}
+	fmt_puts("\r\n");
+}
+
+// load : charge CPU (derniere seconde, pic) et gigue des ISR periodiques en
+// cycles, histogramme log2 de |ecart| (k:n) ; load r : remise a zero ;
+// load th <pour mille> : seuil d'alerte
+int load_cmd(int argc, char ** argv){
+	if(argc == 3 && !strcmp(argv[1], "th")){
+		int th = atoi(argv[2]);
+
+		if(th <= 0 || th > CPULOAD_FULL){
+			fmt_puts("seuil 1..1000 pour mille\r\n");
+			return -1;
+		}
+		cpuload.threshold = th;
+	}
+	else if(argc == 2 && !strcmp(argv[1], "r")){
+		cpuload_clear(&cpuload);
+		cpuload_reported = 0;
+		jitter_reset(&jitter_tick);
+		jitter_reset(&jitter_adc);
+	}
+
+	fmt_puts("charge = ");
+	fmt_put_fixed(cpuload.load, 1);
+	fmt_puts(" %, pic = ");
+	fmt_put_fixed(cpuload.peak, 1);
+	fmt_puts(" %, seuil = ");
+	fmt_put_fixed(cpuload.threshold, 1);
+	fmt_puts(cpuload.warning ? " % ATTENTION\r\n" : " %\r\n");
+	fmt_puts("tour a vide = ");
+	fmt_put_u32(cpuload.cost >> CPULOAD_COST_SHIFT);
+	fmt_puts(" cycles, alertes = ");
+	fmt_put_u32(cpuload.warnings);
+	fmt_puts("\r\nisr\tT\tn\tmin\tmax\tmoy|e|\tmanq.\thist\r\n");
+	jitter_print("tim6", &jitter_tick);
+	jitter_print("adc", &jitter_adc);
+
+	return 0;
+}
+
+#ifdef PROF_ENABLE
+// prof : duree des ISR et des taches en cycles (min, moyenne, max) et
+// histogramme log2 (k:n, n mesures de 2^k a 2^(k+1)-1 cycles) ; prof r : remise a zero
+int prof_cmd(int argc, char ** argv){
+	if(argc == 2 && !strcmp(argv[1], "r")){
+		for(uint8_t i = 0 ; i < PROF_SITES ; i++) prof_reset(&prof[i]);
+		return 0;
+	}
+
+	fmt_puts("site\tn\tmin\tmoy\tmax\thist\r\n");
+	for(uint8_t i = 0 ; i < PROF_SITES ; i++){
+		prof_site_t p;
+		uint32_t basepri = __get_BASEPRI();
+
+		// Copie cohérente : l'écrivain le plus prioritaire est la boucle de courant
+		__set_BASEPRI_MAX(IRQ_BASEPRI(IRQ_PRIO_CURRENT));
+		p = prof[i];
+		__set_BASEPRI(basepri);
+
+		fmt_puts(p.name);
+		fmt_puts("\t");
+		fmt_put_u32(p.n);
+		fmt_puts("\t");
+		fmt_put_u32((p.n > 0) ? p.min : 0);
+		fmt_puts("\t");
+		fmt_put_u32(prof_mean(&p));
+		fmt_puts("\t");
+		fmt_put_u32(p.max);
+		fmt_puts("\t");
+		for(uint8_t k = 0 ; k < PROF_HIST_BINS ; k++){
+			if(p.hist[k] == 0) continue;
+			fmt_put_u32(k);
+			fmt_puts(":");
+			fmt_put_u32(p.hist[k]);
+			fmt_puts(" ");
+		}
+		fmt_puts("\r\n");
+	}
+
+	return 0;
+}
+#endif
+
+SHELL_CMD(f, fonction, "Fonction exemple");
+SHELL_CMD(a, hacheur, "Activation hacheur");
+SHELL_CMD(s, speed, "Vitesse");
+SHELL_CMD(i, isr_stats, "Temps max ISR uart (i 0 : remise a zero)");
+SHELL_CMD(p, proto_stats, "Statistiques protocole binaire");
+SHELL_CMD(e, enc_stats, "Position codeur");
+SHELL_CMD(v, vel_stats, "Vitesse codeur (v fc <Hz> : filtre)");
+SHELL_CMD(t, telem_stats, "Telemetrie (t <masque> <decimation> | t off)");
+SHELL_CMD(lat, lat_cmd, "Latence ISR courant (lat r : remise a zero, puis saturer le shell)");
+SHELL_CMD(load, load_cmd, "Charge CPU et gigue ISR (load r : remise a zero | load th <pour mille>)");
+SHELL_CMD(sched, sched_cmd, "Executif (sched r : remise a zero, sortie du mode degrade)");
+#ifdef PROF_ENABLE
+SHELL_CMD(prof, prof_cmd, "Profilage ISR et taches en cycles (prof r : remise a zero)");
+#endif
+SHELL_CMD(fault, fault_cmd, "Defaut de surintensite (fault r : rearmement)");
+SHELL_CMD(cal, cal_cmd, "Etalonnage ADC (cal o | cal g <voie> <u> <courant A> | cal r)");
+SHELL_CMD(adc, adc_cmd, "ADC (adc ovs <log2> <decalage> | adc f <voie> none|iir|ma [ordre] | adc 0)");
+SHELL_CMD(id, sysid_cmd, "Identification SBPA (id <biais> <amplitude> [hold])");
+SHELL_CMD(o, scope_cmd, "Scope (o arm|go|stop | o ch|pre|dec <n> | o trig <voie> <m|r|f|h|b> <niveau>)");
+
 /* USER CODE END 0 */
 
 /**
@@ -123,7 +1240,9 @@ int speed(int argc, char ** argv){
 int main(void)
 {
 	/* USER CODE BEGIN 1 */
-
+#ifdef PROF_ENABLE
+	for(uint8_t i = 0 ; i < PROF_SITES ; i++) prof_init(&prof[i], prof_names[i]);
+#endif
 	/* USER CODE END 1 */
 
 	/* MCU Configuration--------------------------------------------------------*/
@@ -150,23 +1269,107 @@ int main(void)
 	MX_TIM6_Init();
 	MX_DMA_Init();
 	MX_ADC1_Init();
+	MX_TIM7_Init();
 	/* USER CODE BEGIN 2 */
-	shell_init();
-	shell_add('f', fonction, "Fonction exemple");
-	shell_add('a', hacheur, "Activation hacheur");
-	shell_add('s', speed, "Vitesse");
+	uart_init(&hlpuart1);
+	shell_init(&shell_uart_io, "");
+
+	// Protocole binaire sur la meme liaison que le shell
+	shell_set_frame_handler(protocol_rx_byte);
+	protocol_add_handler(PROTOCOL_SET_DUTY, proto_set_duty);
+	protocol_add_handler(PROTOCOL_SET_SPEED, proto_set_speed);
+	protocol_add_handler(PROTOCOL_MOVE, proto_move);
+	protocol_add_handler(PROTOCOL_TELEM, proto_telem);
+	protocol_add_handler(PROTOCOL_SCOPE, proto_scope);
+	protocol_add_handler(PROTOCOL_MOTOR, proto_motor);
+	telem_init(&telemetry);
+	scope_init(&scope);
+	fault_init(&fault);
+	protocol_add_var(0, &ticks, sizeof(ticks));
+	protocol_add_var(1, &value[0], sizeof(value[0]));
+	protocol_add_var(2, &value[1], sizeof(value[1]));
+	protocol_add_var(6, &value_filt[0], sizeof(value_filt[0]));
+	protocol_add_var(7, &value_filt[1], sizeof(value_filt[1]));
+	protocol_add_var(3, &TIM1->CCR1, sizeof(TIM1->CCR1));
+	protocol_add_var(4, &TIM1->CCR2, sizeof(TIM1->CCR2));
+	protocol_add_var(5, &motor_state, sizeof(motor_state));
+	protocol_add_var(8, &cpuload.load, sizeof(cpuload.load));
+	protocol_add_var(9, &cpuload.warning, sizeof(cpuload.warning));
+
+	// Compteur de cycles DWT pour la mesure des temps d'ISR
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
 	TIM1->PSC = 5-1;	// car il compte et decompte
 	TIM1->ARR = 1024-1;
+	TIM1->CCR4 = TIM1->ARR - ADC_TRIG_ADVANCE;	// déclenchement ADC, suit ARR
 
 	TIM1->CCR1 = 614;
 	TIM1->CCR2 = 1023-614;
 
-	HAL_TIM_Base_Start_IT(&htim6);
-	HAL_TIM_Encoder_Start(&htim2, TIM_CHANNEL_1 || TIM_CHANNEL_2);
+	control_init(&encoder);
+	motor_init();
+
+	// Périodes nominales en cycles : TIM6, et une séquence ADC par période MLI
+	cpuload_init(&cpuload, CPU_LOAD_WARN);
+	jitter_init(&jitter_tick, (TIM6->PSC + 1) * (TIM6->ARR + 1));
+	jitter_init(&jitter_adc, (TIM1->PSC + 1) * 2 * (TIM1->ARR + 1));
+
+	// Tâches de fond par priorité décroissante, enregistrées avant le premier
+	// tick TIM6 ; les boucles de courant et de vitesse restent dans les ISR
+	sched_init(&scheduler, sched_clock, sched_fallback);
+	sched_add(&scheduler, "ctrl", task_control, SCHED_MS(1), 0, SCHED_US(100), SCHED_ESSENTIAL);
+	sched_add(&scheduler, "shell", task_shell, SCHED_MS(5), SCHED_MS(1), SCHED_US(2000), SCHED_ESSENTIAL);
+	sched_add(&scheduler, "telem", task_telemetry, SCHED_MS(1), 0, SCHED_US(200), 0);
+	sched_add(&scheduler, "house", task_housekeeping, SCHED_MS(1000), SCHED_MS(3), SCHED_US(500), 0);
+
+	// Compteur codeur libre, jamais remis a zero : origine prise avant le premier tick TIM6
+	HAL_TIM_Encoder_Start(&htim2, TIM_CHANNEL_ALL);
+	enc_init(&encoder, TIM2->CNT, ENC_TICKS_PER_REV);
+	vel_init(&velocity, ENC_TICKS_PER_REV, VEL_EDGE_TICKS, SystemCoreClock, VEL_TIMEOUT_S);
+	vel_set_filter(&velocity, VEL_FILTER_HZ, SPEED_LOOP_HZ);
+
+	// Coût d'un tour à vide de la boucle principale : même code, aucune tâche
+	// libérée avant le premier tick TIM6, interruptions masquées (~3 ms)
+	__disable_irq();
+	uint32_t idle_start = DWT->CYCCNT;
+
+	for(uint32_t n = 0 ; n < CPU_LOAD_CAL_LOOPS ; n++){
+		if(sched_run(&scheduler) == 0) cpuload_idle(&cpuload);
+	}
+	uint32_t idle_cycles = DWT->CYCCNT - idle_start;
+
+	__enable_irq();
+	cpuload_calibrate(&cpuload, idle_cycles, CPU_LOAD_CAL_LOOPS, DWT->CYCCNT);
 
-	//HAL_ADCEx_Calibration_Start(&hadc1, ADC_SINGLE_ENDED);
-	HAL_ADC_Start_DMA(&hadc1, value, 2);
+	// Étalonnage : auto-étalonnage ADC puis offsets pont désactivé
+	uint32_t cal_start = DWT->CYCCNT;
+
+	adc_cal_boot_status = adc_self_calibration();
+	for(uint8_t c = 0 ; c < ADC_CHANNELS ; c++){
+		filt_init(&adc_filter[c]);
+	}
+	adc_start(value, ADC_CHANNELS);
+	// Attente active acceptable ici : l'exécutif n'est pas encore lancé
+	if(adc_cal_boot_status == 0) adc_cal_boot_status = adc_offset_start();
+	if(adc_cal_boot_status == 0){
+		while((adc_cal_boot_status = adc_cal_process()) == 1);
+	}
+	adc_cal_boot_cycles = DWT->CYCCNT - cal_start;
+
+	// Protection : chien de garde ADC -> arrêt logiciel TIM1
+	overcurrent_config();
+	adc_awd_enable(1);
+
+	fmt_puts("etalonnage ADC : ");
+	fmt_puts(adc_cal_boot_status == 0 ? "ok, " : "echec (valeurs nominales), ");
+	fmt_put_u32(adc_cal_boot_cycles / (SystemCoreClock / 1000000));
+	fmt_puts(" us\r\n");
+
+	// Exécutif lancé juste avant la boucle : un tick TIM6 pendant l'étalonnage
+	// bloquant compterait chaque libération non servie comme échéance manquée
+	HAL_TIM_Base_Start_IT(&htim6);
 
 	/* USER CODE END 2 */
 
@@ -174,28 +1377,7 @@ int main(void)
 	/* USER CODE BEGIN WHILE */
 	while (1)
 	{
-		if (hacheurStart == 1){
-			HAL_GPIO_WritePin(ISO_RESET_GPIO_Port, ISO_RESET_Pin, 1);
-			HAL_Delay(1);
-			HAL_GPIO_WritePin(ISO_RESET_GPIO_Port, ISO_RESET_Pin, 0);
-
-			HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_1);
-			HAL_TIMEx_PWMN_Start(&htim1, TIM_CHANNEL_1);
-
-			HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_2);
-			HAL_TIMEx_PWMN_Start(&htim1, TIM_CHANNEL_2);
-		}
-		else{
-			HAL_GPIO_WritePin(ISO_RESET_GPIO_Port, ISO_RESET_Pin, 0);
-
-			HAL_TIM_PWM_Stop(&htim1, TIM_CHANNEL_1);
-			HAL_TIMEx_PWMN_Stop(&htim1, TIM_CHANNEL_1);
-			HAL_TIM_PWM_Stop(&htim1, TIM_CHANNEL_2);
-			HAL_TIMEx_PWMN_Stop(&htim1, TIM_CHANNEL_2);
-		}
-
-		HAL_ADC_Start_DMA(&hadc1, value, 2);
-		HAL_Delay(1000);
+		if(sched_run(&scheduler) == 0) cpuload_idle(&cpuload);
 		/* USER CODE END WHILE */
 
 		/* USER CODE BEGIN 3 */
@@ -260,14 +1442,17 @@ void SystemClock_Config(void)
 /* USER CODE BEGIN 4 */
 
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin){
-	if(GPIO_Pin == GPIO_PIN_13){
-		hacheurStart = !hacheurStart;
+	PROF_START(t0);
 
-		if(hacheurStart == 1){
-			printf("Hacheur active !\r\n");
+	if(GPIO_Pin == GPIO_PIN_13){
+		if(motor_post(MOTOR_EV_TOGGLE) != 0){
+			fmt_puts("Defaut verrouille (fault r) !\r\n");
+		}
+		else if(motor_state == MOTOR_RESETTING){
+			fmt_puts("Hacheur active !\r\n");
 		}
 		else{
-			printf("Hacheur desactive !\r\n");
+			fmt_puts("Hacheur desactive !\r\n");
 		}
 	}
 
@@ -278,32 +1463,177 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin){
 		if(hacheurStart) printf("ticks/tour = %d\r\n",(int)ticks);
 		 */
 	}
+	PROF_STOP(prof[PROF_EXTI], t0);
 }
 
 void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc){
 	if(hadc->Instance == ADC1){
-		printf("%d\t%d\r\n",(int)value[0],(int)value[1]);
+		jitter_stamp(&jitter_adc, DWT->CYCCNT);
+		PROF_START(t0);
+
+		// Une séquence par période MLI (hacheur actif)
+		adc_sequences++;
+
+		// Mise à l'échelle 16 bits, étalonnage puis filtre par voie
+		uint32_t start = DWT->CYCCNT;
+		uint8_t norm = adc_norm_shift();
+
+		uint8_t cal = (adc_cal_remaining != 0);
+
+		for(uint8_t c = 0 ; c < ADC_CHANNELS ; c++){
+			int32_t x = value[c] << norm;
+			int32_t y;
+
+			if(cal) adc_cal_sum[c] += x;
+			y = ADC_FE_MID + (((x - adc_cal.offset[c]) * adc_cal.gain[c]) >> ADC_CAL_GAIN_SHIFT);
+			if(y < 0) y = 0;
+			else if(y > 0xFFFF) y = 0xFFFF;
+			value_filt[c] = filt_update(&adc_filter[c], y);
+		}
+		if(cal) adc_cal_remaining--;
+
+		uint32_t cycles = DWT->CYCCNT - start;
+		adc_fe_cycles_last = cycles;
+		if(cycles > adc_fe_cycles_max) adc_fe_cycles_max = cycles;
+
+		control_adc_isr((const uint32_t *)value_filt);
+
+		telem_record_t * r = telem_begin(&telemetry);
+		if(r != NULL){
+			enc_snapshot_t snap;
+
+			enc_get(&encoder, &snap);
+			r->t = DWT->CYCCNT;
+			r->ch[TELEM_CH_ADC0] = value_filt[0];
+			r->ch[TELEM_CH_ADC1] = value_filt[1];
+			r->ch[TELEM_CH_CURRENT] = (int32_t)(control_current_get() * 1000.0f);
+			r->ch[TELEM_CH_POSITION] = (int32_t)snap.position;
+			r->ch[TELEM_CH_SPEED] = (int32_t)(control_speed_get() * 1000.0f);
+			r->ch[TELEM_CH_DUTY] = TIM1->CCR1;
+			r->ch[TELEM_CH_LOAD] = cpuload.load;
+			r->ch[TELEM_CH_JITTER] = jitter_tick.dev_last;
+			telem_commit(&telemetry);
+		}
+
+		int16_t sample[SCOPE_CHANNELS];
+		uint32_t cnt = TIM2->CNT;
+
+		// Courants centrés : tiennent en int16 et le niveau de déclenchement
+		// se règle autour de 0
+		sample[SCOPE_CH_ADC0] = (int16_t)(value_filt[0] - ADC_FE_MID);
+		sample[SCOPE_CH_ADC1] = (int16_t)(value_filt[1] - ADC_FE_MID);
+		sample[SCOPE_CH_DUTY] = TIM1->CCR1;
+		sample[SCOPE_CH_DELTA] = (int16_t)(cnt - scope_cnt);
+		scope_cnt = cnt;
+		scope_sample(&scope, sample);
+		PROF_STOP(prof[PROF_ADC], t0);
+	}
+}
+
+// Premier appel de l'ISR DMA1_Channel1 : temps écoulé depuis le déclenchement
+// TRGO2 (CNT = ARR - ADC_TRIG_ADVANCE en montée), conversion comprise.
+// Comptage centré : montée de 0 à ARR - 1, puis descente de ARR à 1 (DIR à
+// 1). Depuis le déclenchement : CNT - (ARR - ADC_TRIG_ADVANCE) ticks en
+// montée, ADC_TRIG_ADVANCE + (ARR - CNT) en descente. Au-delà d'une
+// demi-période, la mesure se replie.
+void latency_probe(void){
+	uint32_t cnt = TIM1->CNT;
+	uint32_t arr = TIM1->ARR;
+	uint32_t ticks;
+
+	if(TIM1->CR1 & TIM_CR1_DIR) ticks = ADC_TRIG_ADVANCE + (arr - cnt);
+	else if(cnt >= arr - ADC_TRIG_ADVANCE) ticks = cnt - (arr - ADC_TRIG_ADVANCE);
+	else return;
+
+	uint32_t cycles = ticks * (TIM1->PSC + 1);
+
+	if(cycles < lat_min) lat_min = cycles;
+	if(cycles > lat_max) lat_max = cycles;
+	lat_n++;
+}
+
+// Chien de garde ADC : arrêt logiciel TIM1 en premier (MOE remis à zéro par
+// le matériel, sorties à l'état de repos), puis verrouillage du défaut
+void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef* hadc){
+	TIM1->EGR = TIM_EGR_BG;
+	uint32_t cycles = DWT->CYCCNT;
+
+	adc_awd_enable(0);
+	motor_trip();
+
+	// Voie la plus éloignée du zéro, dans la séquence déjà transférée par DMA
+	uint8_t norm = adc_norm_shift();
+	uint8_t channel = 0;
+	int32_t worst = 0;
+
+	for(uint8_t c = 0 ; c < ADC_CHANNELS ; c++){
+		int32_t d = (((int32_t)(value[c] << norm) - adc_cal.offset[c]) * adc_cal.gain[c]) >> ADC_CAL_GAIN_SHIFT;
+
+		if(abs(d) > abs(worst)){
+			worst = d;
+			channel = c;
+		}
 	}
+	fault_trip(&fault, FAULT_OVERCURRENT, channel,
+			(int32_t)(worst * (CURRENT_A_PER_LSB * 1000.0f / CURRENT_ADC_SCALE)), cycles, HAL_GetTick());
 }
 
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim){
 	if(htim->Instance == TIM6){
-		ticks = TIM2->CNT;
-		TIM2->CNT = 0;
+		jitter_stamp(&jitter_tick, DWT->CYCCNT);
+		PROF_START(t0);
 
-		float vit = ((float)ticks * 2 * M_PI * ENC_FREQ_ECH) / (float)ENC_TICKS_PER_REV;
+		// Capture plus prioritaire que ce tick : désarmée pendant vel_update()
+		__HAL_TIM_DISABLE_IT(&htim2, TIM_IT_CC1);
+		ticks = enc_update(&encoder, TIM2->CNT);
+		float w = vel_update(&velocity, DWT->CYCCNT);
 
-		if(hacheurStart){
-			//printf("ticks = %d\r\n",ticks);
-			//printf("vit = %f rad/s\r\n",vit);
-		}
+		// Methode M/T : le premier front TI1 apres ce tick ferme la fenetre suivante
+		__HAL_TIM_CLEAR_FLAG(&htim2, TIM_FLAG_CC1);
+		__HAL_TIM_ENABLE_IT(&htim2, TIM_IT_CC1);
+
+		// Boucle de vitesse (SPEED_LOOP_HZ)
+		control_speed_isr(w);
+
+		if(motor_state == MOTOR_ARMED && control_active()) motor_post(MOTOR_EV_RUN);
+
+		sched_tick(&scheduler);
+		PROF_STOP(prof[PROF_TIM6], t0);
+	}
+	else if(htim->Instance == TIM7){
+		PROF_START(t0);
+
+		// Fin de l'impulsion ISO_RESET (une impulsion)
+		motor_post(MOTOR_EV_RESET_DONE);
+		PROF_STOP(prof[PROF_TIM7], t0);
 	}
 }
 
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart){
+void HAL_TIM_IC_CaptureCallback(TIM_HandleTypeDef *htim){
+	if(htim->Instance == TIM2 && htim->Channel == HAL_TIM_ACTIVE_CHANNEL_1){
+		// Date du front par DWT. IRQ_PRIO_CAPTURE : seul le chien de garde ADC
+		// (défaut, arrêt du pont) peut la retarder. Retard en marche normale :
+		// synchronisation de l'entrée TI1 (quelques cycles), entrée d'ISR
+		// (12 cycles) et HAL_TIM_IRQHandler jusqu'ici, soit une centaine de
+		// cycles (< 1 µs) au pire, contre toute une ISR ADC ou TIM6 avant
+		// quand la capture partageait la priorité de TIM6.
+		uint32_t t = DWT->CYCCNT;
+
+		__HAL_TIM_DISABLE_IT(&htim2, TIM_IT_CC1);
+		vel_capture(&velocity, TIM2->CCR1, t);
+	}
+}
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size){
 	if(huart->Instance == LPUART1){
-		shell_char_received();
-		HAL_UART_Receive_IT(&hlpuart1, (uint8_t*)&c, 1);
+		uint32_t start = DWT->CYCCNT;
+
+		uart_rx_event(huart, Size);
+
+		uint32_t cycles = DWT->CYCCNT - start;
+		if(cycles > uart_isr_cycles_max) uart_isr_cycles_max = cycles;
+		uart_rx_events++;
+		PROF_STOP(prof[PROF_UART], start);
 	}
 }
 